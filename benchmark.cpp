@@ -0,0 +1,423 @@
+#include "narrow_bridge.hpp"
+#include "shared_bridge.hpp"
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <new>
+
+// Результат одного прогона сценария
+struct BenchResult {
+    std::string name;      // Название настройки
+    double makespan_ms;    // Время от начала до переезда последней машины
+    double throughput;     // Машин в секунду
+    double p50_ms;         // Медиана ожидания
+    double p99_ms;         // p99 ожидания
+    double max_ms;         // Максимальное ожидание
+    int switches;          // Смены направления
+    int crossed;           // Переехавшие машины
+};
+
+// Машина в расписании сценария
+struct ScheduledCar {
+    std::chrono::microseconds at; // Момент прибытия от начала прогона
+    bool from_north;              // Направление
+};
+
+// Фаза сценария: длительность и интенсивности прибытия по направлениям
+struct Phase {
+    int duration_ms;
+    double north_rate;
+    double south_rate;
+};
+
+// Пуассоновское расписание прибытия по фазам (одинаковое для всех настроек)
+std::vector<ScheduledCar> buildSchedule(const std::vector<Phase>& phases, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::vector<ScheduledCar> schedule;
+    double phase_start_us = 0.0;
+
+    for (const Phase& phase : phases) {
+        double phase_end_us = phase_start_us + phase.duration_ms * 1000.0;
+        for (int d = 0; d < 2; ++d) {
+            double rate = d == 0 ? phase.north_rate : phase.south_rate;
+            if (rate <= 0) {
+                continue;
+            }
+            std::exponential_distribution<double> interval(rate);
+            double t = phase_start_us + interval(gen) * 1e6;
+            while (t < phase_end_us) {
+                ScheduledCar car = {std::chrono::microseconds(static_cast<long long>(t)), d == 0};
+                schedule.push_back(car);
+                t += interval(gen) * 1e6;
+            }
+        }
+        phase_start_us = phase_end_us;
+    }
+
+    std::sort(schedule.begin(), schedule.end(), [](const ScheduledCar& a, const ScheduledCar& b) {
+        return a.at < b.at;
+    });
+    return schedule;
+}
+
+// Прогон расписания через мост: поток на машину, как в основном приложении
+BenchResult runSchedule(const std::string& name, const BridgeConfig& config,
+                        const std::vector<ScheduledCar>& schedule) {
+    NarrowBridge bridge(config);
+    std::vector<std::thread> cars;
+    cars.reserve(schedule.size());
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < schedule.size(); ++i) {
+        std::this_thread::sleep_until(start_time + schedule[i].at);
+        int car_id = static_cast<int>(i + 1);
+        if (schedule[i].from_north) {
+            cars.emplace_back(&NarrowBridge::arriveFromNorth, &bridge, car_id);
+        } else {
+            cars.emplace_back(&NarrowBridge::arriveFromSouth, &bridge, car_id);
+        }
+    }
+    for (auto& car : cars) {
+        if (car.joinable()) {
+            car.join();
+        }
+    }
+    auto end_time = std::chrono::steady_clock::now();
+
+    BenchResult result;
+    result.name = name;
+    result.makespan_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+    result.throughput = bridge.getSuccessfulCrossings() / (result.makespan_ms / 1000.0);
+    result.p50_ms = bridge.getWaitTimes().percentileMs(0.50);
+    result.p99_ms = bridge.getWaitTimes().percentileMs(0.99);
+    result.max_ms = bridge.getWaitTimes().maxMs();
+    result.switches = bridge.getDirectionSwitches();
+    result.crossed = bridge.getSuccessfulCrossings();
+    return result;
+}
+
+// Выравнивание текста по ширине в символах (std::setw считает байты UTF-8)
+std::string pad(const std::string& text, size_t width, bool left) {
+    size_t length = 0;
+    for (char c : text) {
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) {
+            length++;
+        }
+    }
+    std::string padding(length < width ? width - length : 0, ' ');
+    return left ? text + padding : padding + text;
+}
+
+void printHeader() {
+    std::cout << pad("настройка", 16, true)
+              << pad("время, мс", 12, false)
+              << pad("машин/с", 12, false)
+              << pad("p50, мс", 10, false)
+              << pad("p99, мс", 10, false)
+              << pad("max, мс", 10, false)
+              << pad("смен", 10, false) << std::endl;
+}
+
+void printResult(const BenchResult& result) {
+    std::cout << pad(result.name, 16, true)
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << result.makespan_ms
+              << std::setw(12) << result.throughput
+              << std::setprecision(3)
+              << std::setw(10) << result.p50_ms
+              << std::setw(10) << result.p99_ms
+              << std::setw(10) << result.max_ms
+              << std::setw(10) << result.switches << std::endl;
+}
+
+// Сценарий "час пик": утром поток с севера, днем равномерно, вечером с юга.
+// Фиксированные лимиты пачки сравниваются с адаптивным контроллером.
+int benchmarkSwitching(int crossing_ms, double p99_target_ms, unsigned int seed) {
+    std::vector<Phase> phases;
+    Phase morning = {2000, 300.0, 80.0};
+    Phase midday = {2000, 80.0, 80.0};
+    Phase evening = {2000, 80.0, 300.0};
+    phases.push_back(morning);
+    phases.push_back(midday);
+    phases.push_back(evening);
+    std::vector<ScheduledCar> schedule = buildSchedule(phases, seed);
+
+    std::cout << "=== СЦЕНАРИЙ: ЧАС ПИК (смена направления) ===" << std::endl;
+    std::cout << "Машин: " << schedule.size() << ", время переезда: " << crossing_ms
+              << " мс, цель p99: " << p99_target_ms << " мс" << std::endl;
+    printHeader();
+
+    BridgeConfig base;
+    base.verbose = false;
+    base.crossing_time_ms = crossing_ms;
+
+    std::vector<BenchResult> fixed_results;
+    const int fixed_limits[] = {0, 1, 2, 4, 8, 16, 32, 64};
+    for (int limit : fixed_limits) {
+        BridgeConfig config = base;
+        config.max_batch = limit;
+        std::string name = limit == 0 ? "без лимита" : "пачка " + std::to_string(limit);
+        fixed_results.push_back(runSchedule(name, config, schedule));
+        printResult(fixed_results.back());
+    }
+
+    SwitchControllerConfig controller_config;
+    controller_config.p99_target_ms = p99_target_ms;
+    AdaptiveSwitchController controller(controller_config);
+    BridgeConfig adaptive_config = base;
+    adaptive_config.switch_controller = &controller;
+    BenchResult adaptive = runSchedule("адаптивный", adaptive_config, schedule);
+    printResult(adaptive);
+
+    SwitchControllerMetrics metrics = controller.metrics();
+    std::cout << "Контроллер: пересчетов " << metrics.adjustments
+              << ", увеличений " << metrics.increases
+              << ", уменьшений " << metrics.decreases
+              << ", итоговые лимиты: север " << metrics.north_batch
+              << ", юг " << metrics.south_batch << std::endl;
+
+    // Настройка, нарушившая цель p99, проигрывает. Среди уложившихся сравнивается
+    // пропускная способность; разница меньше 1% считается ничьей
+    int wins = 0;
+    int ties = 0;
+    int losses = 0;
+    bool adaptive_meets_target = adaptive.p99_ms <= p99_target_ms;
+    for (const BenchResult& fixed : fixed_results) {
+        bool fixed_meets_target = fixed.p99_ms <= p99_target_ms;
+        if (adaptive_meets_target && !fixed_meets_target) {
+            wins++;
+        } else if (!adaptive_meets_target && fixed_meets_target) {
+            losses++;
+        } else if (adaptive.throughput > fixed.throughput * 1.01) {
+            wins++;
+        } else if (adaptive.throughput < fixed.throughput * 0.99) {
+            losses++;
+        } else {
+            ties++;
+        }
+    }
+    std::cout << "Адаптивный контроллер против " << fixed_results.size() << " фиксированных настроек: "
+              << "лучше " << wins << ", на уровне " << ties << ", хуже " << losses << std::endl;
+    return 0;
+}
+
+// Общая для участников память прогона "потоки против процессов": барьер старта,
+// моменты окончания и сырые задержки допуска каждой машины. Лежит в анонимном
+// разделяемом отображении, поэтому одинаково работает и для потоков, и для fork()
+struct ContendedRun {
+    std::atomic<int> attached;       // Участники, подключившиеся к мосту
+    std::atomic<bool> go;            // Старт после подключения всех участников
+    long long start_ns;              // Момент старта (steady_clock, общий для процессов)
+    long long* finish_ns;            // Момент окончания у каждого участника
+    long long* latencies_ns;         // Задержка допуска каждой машины
+};
+
+// Момент въезда текущей машины; задается обработчиком on_admit в потоке этой машины
+thread_local std::chrono::steady_clock::time_point admitted_at;
+
+long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ContendedRun* createContendedRun(int workers, int cars_per_worker) {
+    size_t bytes = sizeof(ContendedRun) + sizeof(long long) * workers * (1 + static_cast<size_t>(cars_per_worker));
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    ContendedRun* run = new (memory) ContendedRun();
+    run->attached.store(0);
+    run->go.store(false);
+    run->finish_ns = reinterpret_cast<long long*>(run + 1);
+    run->latencies_ns = run->finish_ns + workers;
+    return run;
+}
+
+void destroyContendedRun(ContendedRun* run, int workers, int cars_per_worker) {
+    munmap(run, sizeof(ContendedRun) + sizeof(long long) * workers * (1 + static_cast<size_t>(cars_per_worker)));
+}
+
+// Участник прогона: ждет общего старта, затем проводит свои машины, чередуя направления
+template <typename Bridge>
+void driveContended(Bridge& bridge, ContendedRun* run, int worker, int cars_per_worker) {
+    run->attached++;
+    while (!run->go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    long long* latencies = run->latencies_ns + static_cast<size_t>(worker) * cars_per_worker;
+    for (int i = 0; i < cars_per_worker; ++i) {
+        int car_id = worker * cars_per_worker + i;
+        auto arrived_at = std::chrono::steady_clock::now();
+        if ((worker + i) % 2 == 0) {
+            bridge.arriveFromNorth(car_id);
+        } else {
+            bridge.arriveFromSouth(car_id);
+        }
+        latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(admitted_at - arrived_at).count();
+    }
+    run->finish_ns[worker] = nowNs();
+}
+
+// Старт после подключения всех участников
+void startContendedRun(ContendedRun* run, int workers) {
+    while (run->attached.load() < workers) {
+        std::this_thread::yield();
+    }
+    run->start_ns = nowNs();
+    run->go.store(true, std::memory_order_release);
+}
+
+// Итог по сырым задержкам: точные квантили вместо оценки по корзинам гистограммы
+BenchResult contendedResult(const std::string& name, ContendedRun* run, int workers, int cars_per_worker,
+                            int switches, int crossed) {
+    long long finish_ns = run->start_ns;
+    for (int w = 0; w < workers; ++w) {
+        finish_ns = std::max(finish_ns, run->finish_ns[w]);
+    }
+    std::vector<long long> latencies(run->latencies_ns,
+                                     run->latencies_ns + static_cast<size_t>(workers) * cars_per_worker);
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double q) {
+        return latencies[static_cast<size_t>(q * (latencies.size() - 1))] / 1e6;
+    };
+
+    BenchResult result;
+    result.name = name;
+    result.makespan_ms = (finish_ns - run->start_ns) / 1e6;
+    result.throughput = crossed / (result.makespan_ms / 1000.0);
+    result.p50_ms = percentile(0.50);
+    result.p99_ms = percentile(0.99);
+    result.max_ms = latencies.back() / 1e6;
+    result.switches = switches;
+    result.crossed = crossed;
+    return result;
+}
+
+// Задержка допуска на мост: потоки одного процесса против независимых процессов,
+// работающих с мостом в разделяемой памяти. Каждый участник проводит свои машины
+// по очереди, чередуя направления; пока машина на мосту, встречные ждут, а лимит
+// пачки заставляет постоянно передавать мост встречной стороне. Время отсчитывается
+// после подключения всех участников (без fork() и открытия сегмента), задержки
+// записываются для каждой машины
+int benchmarkSharedMemory(int workers, int cars_per_worker) {
+    const int crossing_ms = 1;
+    const int max_batch = 4;
+    std::cout << "=== СЦЕНАРИЙ: МЕЖПРОЦЕССНЫЙ МОСТ ===" << std::endl;
+    std::cout << "Участников: " << workers << ", машин у каждого: " << cars_per_worker
+              << ", время переезда: " << crossing_ms << " мс, лимит пачки: " << max_batch
+              << " (p50/p99/max - задержка допуска)" << std::endl;
+    printHeader();
+
+    BridgeConfig config;
+    config.verbose = false;
+    config.crossing_time_ms = crossing_ms;
+    config.max_batch = max_batch;
+    config.on_admit = [](int, const std::string&) {
+        admitted_at = std::chrono::steady_clock::now();
+    };
+
+    // Потоки одного процесса, NarrowBridge
+    {
+        ContendedRun* run = createContendedRun(workers, cars_per_worker);
+        if (!run) {
+            std::cerr << "Не удалось выделить память для прогона" << std::endl;
+            return 1;
+        }
+        NarrowBridge bridge(config);
+        std::vector<std::thread> threads;
+        for (int w = 0; w < workers; ++w) {
+            threads.emplace_back(driveContended<NarrowBridge>, std::ref(bridge), run, w, cars_per_worker);
+        }
+        startContendedRun(run, workers);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        printResult(contendedResult("потоки", run, workers, cars_per_worker,
+                                    bridge.getDirectionSwitches(), bridge.getSuccessfulCrossings()));
+        destroyContendedRun(run, workers, cars_per_worker);
+    }
+
+    // Независимые процессы, SharedNarrowBridge
+    {
+        ContendedRun* run = createContendedRun(workers, cars_per_worker);
+        if (!run) {
+            std::cerr << "Не удалось выделить память для прогона" << std::endl;
+            return 1;
+        }
+        const std::string name = "/narrow_bridge_bench_" + std::to_string(getpid());
+        SharedNarrowBridge::remove(name);
+        SharedNarrowBridge bridge(name, config);
+        std::vector<pid_t> children;
+        for (int w = 0; w < workers; ++w) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                SharedNarrowBridge child_bridge(name, config);
+                driveContended(child_bridge, run, w, cars_per_worker);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        startContendedRun(run, workers);
+        for (pid_t child : children) {
+            waitpid(child, nullptr, 0);
+        }
+        printResult(contendedResult("процессы", run, workers, cars_per_worker,
+                                    bridge.getDirectionSwitches(), bridge.getSuccessfulCrossings()));
+        SharedNarrowBridge::remove(name);
+        destroyContendedRun(run, workers, cars_per_worker);
+    }
+    return 0;
+}
+
+// Порядок допуска внутри направления: общая условная переменная против очереди FIFO
+// с передачей права проезда. Оба направления загружены, лимит пачки заставляет
+// часто менять направление, и машины подолгу стоят в очередях
+int benchmarkFifo(unsigned int seed) {
+    std::vector<Phase> phases;
+    Phase rush = {3000, 200.0, 200.0};
+    phases.push_back(rush);
+    std::vector<ScheduledCar> schedule = buildSchedule(phases, seed);
+
+    std::cout << "=== СЦЕНАРИЙ: ПОРЯДОК ДОПУСКА (FIFO) ===" << std::endl;
+    std::cout << "Машин: " << schedule.size() << ", время переезда: 10 мс, лимит пачки: 8" << std::endl;
+    printHeader();
+
+    BridgeConfig config;
+    config.verbose = false;
+    config.crossing_time_ms = 10;
+    config.max_batch = 8;
+    printResult(runSchedule("condvar", config, schedule));
+
+    config.fifo_handoff = true;
+    printResult(runSchedule("FIFO", config, schedule));
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string scenario = argc > 1 ? argv[1] : "switching";
+    unsigned int seed = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 42;
+
+    if (scenario == "switching") {
+        return benchmarkSwitching(20, 250.0, seed);
+    }
+    if (scenario == "fifo") {
+        return benchmarkFifo(seed);
+    }
+    if (scenario == "shared") {
+        return benchmarkSharedMemory(8, 500);
+    }
+
+    std::cerr << "Неизвестный сценарий: " << scenario << std::endl;
+    std::cerr << "Использование: " << argv[0] << " [switching|shared|fifo] [seed]" << std::endl;
+    return 2;
+}
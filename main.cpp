@@ -6,147 +6,16 @@
 #include <vector>
 #include <random>
 #include <atomic>
-
-// Класс для моделирования узкого моста
-class NarrowBridge {
-private:
-    // Мьютекс для синхронизации доступа к общим данным
-    std::mutex mtx;
-    // Условная переменная для координации между потоками
-    std::condition_variable cv;
-    
-    // Счетчики машин на мосту
-    int north_cars_on_bridge = 0;    // Машины с севера на мосту
-    int south_cars_on_bridge = 0;    // Машины с юга на мосту
-    // Счетчики ожидающих машин
-    int north_cars_waiting = 0;      // Машины с севера, ожидающие проезда
-    int south_cars_waiting = 0;      // Машины с юга, ожидающие проезда
-    // Текущее разрешенное направление движения
-    std::string current_direction = "НЕТ"; // "СЕВЕР", "ЮГ", "НЕТ"
-    
-    // Атомарные счетчики для статистики (не требуют мьютекса)
-    std::atomic<int> successful_crossings{0}; // Успешные переезды
-    std::atomic<int> total_cars{0};           // Общее количество машин
-
-public:
-    // Метод для машины, подъезжающей с севера
-    void arriveFromNorth(int car_id) {
-        total_cars++; // Увеличиваем общий счетчик машин
-        
-        {
-            // Захватываем мьютекс для работы с общими данными
-            std::unique_lock<std::mutex> lock(mtx);
-            north_cars_waiting++; // Увеличиваем счетчик ожидающих с севера
-            std::cout << "Машина " << car_id << " с СЕВЕРА подъехала к мосту. Ожидание..." << std::endl;
-            
-            // Ждем, пока можно будет проехать
-            // Условие: на мосту нет машин с юга И направление разрешено для севера
-            cv.wait(lock, [this]() {
-                return south_cars_on_bridge == 0 && 
-                       (current_direction == "СЕВЕР" || current_direction == "НЕТ");
-            });
-            
-            // Условие выполнено - машина может ехать
-            north_cars_waiting--;    // Уменьшаем счетчик ожидающих
-            north_cars_on_bridge++;  // Увеличиваем счетчик на мосту
-            current_direction = "СЕВЕР"; // Устанавливаем направление движения
-            
-            std::cout << "Машина " << car_id << " с СЕВЕРА начала переезд. На мосту: " 
-                      << north_cars_on_bridge << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
-        } // Мьютекс автоматически освобождается при выходе из блока
-        
-        // Имитация времени переезда (мьютекс не захвачен - другие машины могут подъезжать)
-        std::this_thread::sleep_for(std::chrono::milliseconds(500 + car_id % 300));
-        
-        // Завершаем переезд
-        leaveBridge(car_id, "СЕВЕР");
-    }
-    
-    // Метод для машины, подъезжающей с юга (аналогично северу)
-    void arriveFromSouth(int car_id) {
-        total_cars++;
-        {
-            std::unique_lock<std::mutex> lock(mtx);
-            south_cars_waiting++;
-            std::cout << "Машина " << car_id << " с ЮГА подъехала к мосту. Ожидание..." << std::endl;
-            
-            // Ждем, пока можно будет проехать
-            // Условие: на мосту нет машин с севера И направление разрешено для юга
-            cv.wait(lock, [this]() {
-                return north_cars_on_bridge == 0 && 
-                       (current_direction == "ЮГ" || current_direction == "НЕТ");
-            });
-            
-            south_cars_waiting--;
-            south_cars_on_bridge++;
-            current_direction = "ЮГ";
-            
-            std::cout << "Машина " << car_id << " с ЮГА начала переезд. На мосту: " 
-                      << north_cars_on_bridge << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
-        }
-        
-        // Имитация времени переезда
-        std::this_thread::sleep_for(std::chrono::milliseconds(500 + car_id % 300));
-        
-        leaveBridge(car_id, "ЮГ");
-    }
-    
-    // Геттеры для получения статистики
-    int getSuccessfulCrossings() const {
-        return successful_crossings.load();
-    }
-    
-    int getTotalCars() const {
-        return total_cars.load();
-    }
-    
-    bool allCarsCrossedSuccessfully() const {
-        return successful_crossings == total_cars;
-    }
-
-private:
-    // Приватный метод для завершения переезда
-    void leaveBridge(int car_id, const std::string& direction) {
-        // Захватываем мьютекс для изменения общих данных
-        std::unique_lock<std::mutex> lock(mtx);
-        
-        // Уменьшаем счетчик машин на мосту в зависимости от направления
-        if (direction == "СЕВЕР") {
-            north_cars_on_bridge--;
-        } else {
-            south_cars_on_bridge--;
-        }
-        
-        // Увеличиваем счетчик успешных переездов
-        successful_crossings++;
-        
-        // Если все машины уехали с моста в текущем направлении
-        if (north_cars_on_bridge == 0 && south_cars_on_bridge == 0) {
-            // Решаем, какое направление будет следующим
-            if (direction == "СЕВЕР" && south_cars_waiting > 0) {
-                // Если только что ехали с севера и есть ожидающие с юга - разрешаем юг
-                current_direction = "ЮГ";
-            } else if (direction == "ЮГ" && north_cars_waiting > 0) {
-                // Если только что ехали с юга и есть ожидающие с севера - разрешаем север
-                current_direction = "СЕВЕР";
-            } else {
-                // Если ожидающих нет - мост свободен
-                current_direction = "НЕТ";
-            }
-        }
-        
-        // Выводим информацию о завершении переезда
-        std::cout << "Машина " << car_id << " с " << (direction == "СЕВЕР" ? "СЕВЕРА" : "ЮГА") 
-                  << " переехала мост. На мосту осталось: " << north_cars_on_bridge 
-                  << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
-        std::cout << "Текущее направление: " << current_direction 
-                  << ", Ожидают: " << north_cars_waiting << " с севера, " 
-                  << south_cars_waiting << " с юга" << std::endl;
-        
-        // Уведомляем все ожидающие потоки, что состояние изменилось
-        cv.notify_all();
-    }
-};
+#include <string>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include "narrow_bridge.hpp"
+#include "metrics_exporter.hpp"
 
 // Функция для запуска моделирования движения
 void simulateTraffic(NarrowBridge& bridge, int num_cars) {
@@ -216,7 +85,547 @@ int getNumberOfCars() {
     }
 }
 
-int main() {
+// ===== Неинтерактивный режим для нагрузочных прогонов =====
+
+// Максимальное количество машин в неинтерактивном режиме
+const long long MAX_HEADLESS_CARS = 10000000;
+
+// Параметры неинтерактивного запуска
+struct RunOptions {
+    long long num_cars = 0;          // Количество машин
+    std::string arrival = "random";  // Модель прибытия: random, poisson, burst
+    double rate = 10.0;              // Интенсивность прибытия для poisson (машин/с)
+    bool has_seed = false;           // Задан ли seed явно
+    unsigned int seed = 0;           // Seed генератора (для воспроизводимости)
+    std::string mode = "threads";    // threads - поток на машину, pool - пул потоков
+    int workers = 64;                // Размер пула потоков для режима pool
+    int max_threads = 4096;          // Предел одновременных потоков-машин для режима threads
+    int duration_s = 0;              // Ограничение времени подачи машин (0 - без ограничения)
+    std::string format = "human";    // Формат вывода: human, json, csv
+    int progress_ms = 1000;          // Период вывода прогресса
+    int crossing_ms = -1;            // Время переезда (-1 - исходная модель)
+    bool verbose = false;            // Печатать ли сообщения о каждой машине
+    int max_batch = 0;               // Фиксированный лимит пачки (0 - без ограничения)
+    bool adaptive = false;           // Адаптивный контроллер смены направления
+    double p99_target_ms = 1000.0;   // Цель p99 ожидания для адаптивного контроллера
+    bool fifo = false;               // Очередь FIFO с передачей права проезда
+    std::string metrics_address;     // Адрес экспорта метрик Prometheus (пусто - выключен)
+};
+
+// Очередная машина в расписании прибытия
+struct Arrival {
+    int car_id;                      // Номер машины
+    bool from_north;                 // Направление
+    std::chrono::microseconds at;    // Смещение момента прибытия от начала прогона
+};
+
+// Генератор расписания прибытия (потокобезопасный, детерминированный при заданном seed)
+class ArrivalGenerator {
+private:
+    std::mutex mtx;
+    const RunOptions& options;
+    std::mt19937 gen;
+    long long next_id = 1;
+    double offset_us = 0.0;
+
+public:
+    ArrivalGenerator(const RunOptions& run_options, unsigned int seed)
+        : options(run_options), gen(seed) {}
+
+    // Возвращает false, когда все машины уже выданы
+    bool next(Arrival& arrival) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (next_id > options.num_cars) {
+            return false;
+        }
+
+        if (next_id > 1) {
+            if (options.arrival == "poisson") {
+                // Экспоненциальные интервалы между прибытиями
+                std::exponential_distribution<double> interval(options.rate);
+                offset_us += interval(gen) * 1e6;
+            } else if (options.arrival == "random") {
+                // Исходная модель: 100-300 мс между машинами
+                offset_us += (100 + gen() % 200) * 1000.0;
+            }
+            // burst: все машины прибывают одновременно
+        }
+
+        std::uniform_int_distribution<> dir_dist(0, 1);
+        arrival.car_id = static_cast<int>(next_id++);
+        arrival.from_north = dir_dist(gen) == 0;
+        arrival.at = std::chrono::microseconds(static_cast<long long>(offset_us));
+        return true;
+    }
+};
+
+// Вывод справки по параметрам командной строки
+void printUsage(const char* program) {
+    std::cout << "Использование: " << program << " [параметры]\n"
+              << "Без параметров запускается интерактивный режим.\n\n"
+              << "  --cars N            количество машин (1-" << MAX_HEADLESS_CARS << ")\n"
+              << "  --arrival MODEL     модель прибытия: random (по умолчанию), poisson, burst\n"
+              << "  --rate R            интенсивность для poisson, машин/с (по умолчанию 10)\n"
+              << "  --seed S            seed генератора случайных чисел\n"
+              << "  --mode MODE         threads (поток на машину, по умолчанию) или pool\n"
+              << "  --workers N         размер пула для режима pool (по умолчанию 64); одновременно\n"
+              << "                      у моста не больше N машин, остальные подаются с опозданием\n"
+              << "  --max-threads N     предел одновременных потоков-машин в режиме threads (по умолчанию 4096)\n"
+              << "  --duration SEC      прекратить подачу машин через SEC секунд\n"
+              << "  --format FMT        формат вывода: human (по умолчанию), json, csv\n"
+              << "  --progress-ms MS    период вывода прогресса (по умолчанию 1000, 0 - отключить)\n"
+              << "  --crossing-ms MS    фиксированное время переезда (по умолчанию 500 + id % 300)\n"
+              << "  --max-batch N       машин подряд в одном направлении, пока ждут встречные (0 - без ограничения)\n"
+              << "  --adaptive          подбирать длину пачки адаптивно по p99 ожидания (без --max-batch)\n"
+              << "  --p99-target-ms MS  цель p99 ожидания для --adaptive (по умолчанию 1000)\n"
+              << "  --fifo              пропускать машины одного направления строго по очереди\n"
+              << "  --metrics ADDR      отдавать метрики Prometheus: порт на 127.0.0.1 или unix:/путь\n"
+              << "  --verbose           печатать сообщения о каждой машине\n"
+              << "  --help              показать эту справку" << std::endl;
+}
+
+// Разбор целого числа с проверкой диапазона
+bool parseInteger(const std::string& text, long long min_value, long long max_value, long long& result) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    long long value = std::strtoll(text.c_str(), &end, 10);
+    if (*end != '\0' || value < min_value || value > max_value) {
+        return false;
+    }
+    result = value;
+    return true;
+}
+
+// Разбор аргументов командной строки; при ошибке заполняет error
+bool parseArguments(int argc, char* argv[], RunOptions& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+
+        // Поддерживаем обе формы: --key value и --key=value
+        std::string::size_type eq = arg.find('=');
+        bool has_inline_value = eq != std::string::npos;
+        if (has_inline_value) {
+            value = arg.substr(eq + 1);
+            arg = arg.substr(0, eq);
+        }
+
+        if (arg == "--verbose") {
+            options.verbose = true;
+            continue;
+        }
+        if (arg == "--adaptive") {
+            options.adaptive = true;
+            continue;
+        }
+        if (arg == "--fifo") {
+            options.fifo = true;
+            continue;
+        }
+
+        if (!has_inline_value) {
+            if (i + 1 >= argc) {
+                error = "не указано значение для " + arg;
+                return false;
+            }
+            value = argv[++i];
+        }
+
+        long long number = 0;
+        if (arg == "--cars") {
+            if (!parseInteger(value, 1, MAX_HEADLESS_CARS, number)) {
+                error = "количество машин должно быть от 1 до " + std::to_string(MAX_HEADLESS_CARS);
+                return false;
+            }
+            options.num_cars = number;
+        } else if (arg == "--arrival") {
+            if (value != "random" && value != "poisson" && value != "burst") {
+                error = "неизвестная модель прибытия: " + value;
+                return false;
+            }
+            options.arrival = value;
+        } else if (arg == "--rate") {
+            char* end = nullptr;
+            double rate = std::strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0' || !(rate > 0.0)) {
+                error = "интенсивность должна быть положительным числом";
+                return false;
+            }
+            options.rate = rate;
+        } else if (arg == "--seed") {
+            if (!parseInteger(value, 0, 4294967295LL, number)) {
+                error = "некорректный seed: " + value;
+                return false;
+            }
+            options.has_seed = true;
+            options.seed = static_cast<unsigned int>(number);
+        } else if (arg == "--mode") {
+            if (value != "threads" && value != "pool") {
+                error = "неизвестный режим потоков: " + value;
+                return false;
+            }
+            options.mode = value;
+        } else if (arg == "--workers") {
+            if (!parseInteger(value, 1, 100000, number)) {
+                error = "размер пула должен быть от 1 до 100000";
+                return false;
+            }
+            options.workers = static_cast<int>(number);
+        } else if (arg == "--max-threads") {
+            if (!parseInteger(value, 1, 1000000, number)) {
+                error = "предел потоков должен быть от 1 до 1000000";
+                return false;
+            }
+            options.max_threads = static_cast<int>(number);
+        } else if (arg == "--duration") {
+            if (!parseInteger(value, 1, 365LL * 24 * 3600, number)) {
+                error = "некорректное ограничение времени: " + value;
+                return false;
+            }
+            options.duration_s = static_cast<int>(number);
+        } else if (arg == "--format") {
+            if (value != "human" && value != "json" && value != "csv") {
+                error = "неизвестный формат вывода: " + value;
+                return false;
+            }
+            options.format = value;
+        } else if (arg == "--progress-ms") {
+            if (!parseInteger(value, 0, 3600000, number)) {
+                error = "некорректный период прогресса: " + value;
+                return false;
+            }
+            options.progress_ms = static_cast<int>(number);
+        } else if (arg == "--crossing-ms") {
+            if (!parseInteger(value, 0, 60000, number)) {
+                error = "время переезда должно быть от 0 до 60000 мс";
+                return false;
+            }
+            options.crossing_ms = static_cast<int>(number);
+        } else if (arg == "--max-batch") {
+            if (!parseInteger(value, 0, 1000000, number)) {
+                error = "лимит пачки должен быть от 0 до 1000000";
+                return false;
+            }
+            options.max_batch = static_cast<int>(number);
+        } else if (arg == "--metrics") {
+            if (value.empty()) {
+                error = "не указан адрес метрик";
+                return false;
+            }
+            options.metrics_address = value;
+        } else if (arg == "--p99-target-ms") {
+            char* end = nullptr;
+            double target = std::strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0' || !(target > 0.0)) {
+                error = "цель p99 должна быть положительным числом";
+                return false;
+            }
+            options.p99_target_ms = target;
+        } else {
+            error = "неизвестный параметр: " + arg;
+            return false;
+        }
+    }
+
+    if (options.num_cars == 0) {
+        error = "не указано количество машин (--cars)";
+        return false;
+    }
+    if (options.adaptive && options.max_batch > 0) {
+        error = "--adaptive сам подбирает лимит пачки и несовместим с --max-batch";
+        return false;
+    }
+    return true;
+}
+
+// Снимок состояния прогона для вывода
+struct RunReport {
+    const char* kind;         // "progress" или "summary"
+    long long elapsed_ms;     // Время от начала прогона
+    long long arrived;        // Машины, подъехавшие к мосту
+    long long crossed;        // Машины, переехавшие мост
+    long long planned;        // Запланированное количество машин
+    double wait_p99_ms;       // p99 времени ожидания у моста
+    double wait_max_ms;       // Максимальное время ожидания
+    int switches;             // Смены направления движения
+    int north_batch;          // Действующий лимит пачки для севера (0 - без ограничения)
+    int south_batch;          // Действующий лимит пачки для юга
+};
+
+// Печать снимка в выбранном формате
+void printReport(const RunOptions& options, const RunReport& report) {
+    double seconds = report.elapsed_ms / 1000.0;
+    double throughput = seconds > 0 ? report.crossed / seconds : 0.0;
+    long long in_flight = report.arrived - report.crossed;
+
+    if (options.format == "json") {
+        std::cout << "{\"type\":\"" << report.kind << "\""
+                  << ",\"elapsed_ms\":" << report.elapsed_ms
+                  << ",\"planned\":" << report.planned
+                  << ",\"arrived\":" << report.arrived
+                  << ",\"crossed\":" << report.crossed
+                  << ",\"in_flight\":" << in_flight
+                  << ",\"throughput\":" << std::fixed << std::setprecision(2) << throughput
+                  << ",\"wait_p99_ms\":" << report.wait_p99_ms
+                  << ",\"wait_max_ms\":" << report.wait_max_ms
+                  << ",\"switches\":" << report.switches
+                  << ",\"north_batch\":" << report.north_batch
+                  << ",\"south_batch\":" << report.south_batch
+                  << "}" << std::endl;
+    } else if (options.format == "csv") {
+        std::cout << report.kind << "," << report.elapsed_ms << "," << report.planned << ","
+                  << report.arrived << "," << report.crossed << "," << in_flight << ","
+                  << std::fixed << std::setprecision(2) << throughput << ","
+                  << report.wait_p99_ms << "," << report.wait_max_ms << "," << report.switches << ","
+                  << report.north_batch << "," << report.south_batch << std::endl;
+    } else if (std::string(report.kind) == "progress") {
+        std::cout << "[" << std::fixed << std::setprecision(1) << seconds << " с] "
+                  << "подъехало: " << report.arrived << "/" << report.planned
+                  << ", переехало: " << report.crossed
+                  << ", на мосту и в очереди: " << in_flight
+                  << ", скорость: " << std::setprecision(2) << throughput << " машин/с"
+                  << ", p99 ожидания: " << report.wait_p99_ms << " мс" << std::endl;
+    } else {
+        std::cout << "=================================" << std::endl;
+        std::cout << "Время выполнения: " << report.elapsed_ms << " мс" << std::endl;
+        std::cout << "Подъехало машин: " << report.arrived << " из " << report.planned << std::endl;
+        std::cout << "Переехало машин: " << report.crossed << std::endl;
+        std::cout << "Пропускная способность: " << std::fixed << std::setprecision(2)
+                  << throughput << " машин/с" << std::endl;
+        std::cout << "Ожидание у моста: p99 " << report.wait_p99_ms << " мс, максимум "
+                  << report.wait_max_ms << " мс" << std::endl;
+        std::cout << "Смен направления: " << report.switches << std::endl;
+        if (report.north_batch > 0 || report.south_batch > 0) {
+            std::cout << "Лимит пачки: север " << report.north_batch << ", юг " << report.south_batch << std::endl;
+        }
+    }
+}
+
+// Неинтерактивный прогон: подача машин по расписанию и потоковый вывод прогресса
+int runHeadless(const RunOptions& options) {
+    BridgeConfig config;
+    config.verbose = options.verbose;
+    config.crossing_time_ms = options.crossing_ms;
+    config.max_batch = options.max_batch;
+    config.fifo_handoff = options.fifo;
+    SwitchControllerConfig controller_config;
+    controller_config.p99_target_ms = options.p99_target_ms;
+    AdaptiveSwitchController controller(controller_config);
+    if (options.adaptive) {
+        config.switch_controller = &controller;
+    }
+    NarrowBridge bridge(config);
+
+    // Экспорт метрик работает в своем потоке и читает счетчики без мьютекса моста
+    std::unique_ptr<MetricsExporter> exporter;
+    if (!options.metrics_address.empty()) {
+        try {
+            exporter.reset(new MetricsExporter(bridge, options.metrics_address));
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка: " << e.what() << std::endl;
+            return 2;
+        }
+    }
+
+    unsigned int seed = options.has_seed ? options.seed : std::random_device()();
+    ArrivalGenerator generator(options, seed);
+
+    std::atomic<long long> arrived{0};       // Машины, поданные к мосту
+    std::atomic<long long> finished{0};      // Машины, завершившие переезд
+    std::atomic<bool> dispatch_done{false};  // Подача машин завершена
+
+    auto start_time = std::chrono::steady_clock::now();
+    bool has_deadline = options.duration_s > 0;
+    auto deadline = start_time + std::chrono::seconds(options.duration_s);
+
+    // Истекло ли время подачи: по текущему времени, а не по расписанию, чтобы
+    // одновременное прибытие и отставание подачи тоже ограничивались --duration
+    auto pastDeadline = [&]() {
+        return has_deadline && std::chrono::steady_clock::now() >= deadline;
+    };
+
+    // Ожидание момента прибытия; false - если подача прекращена по времени
+    auto waitForArrival = [&](const Arrival& arrival) {
+        auto arrival_time = start_time + arrival.at;
+        if (has_deadline && arrival_time >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_until(arrival_time);
+        return !pastDeadline();
+    };
+
+    // Ожидание отсчитывается от момента по расписанию: если машину подали с опозданием
+    // (пул занят или исчерпан предел потоков), задержка подачи тоже попадает в статистику
+    auto drive = [&bridge, &finished, start_time](const Arrival& arrival) {
+        auto scheduled_at = start_time + arrival.at;
+        if (arrival.from_north) {
+            bridge.arriveFromNorthAt(arrival.car_id, scheduled_at);
+        } else {
+            bridge.arriveFromSouthAt(arrival.car_id, scheduled_at);
+        }
+        finished++;
+    };
+
+    std::string launch_error; // Ошибка создания потоков (пусто - не было)
+    std::vector<std::thread> workers;
+    if (options.mode == "pool") {
+        // Фиксированный пул: каждый поток по очереди ведет машины из общего расписания
+        std::atomic<int> active_workers{options.workers};
+        auto worker = [&]() {
+            Arrival arrival;
+            while (generator.next(arrival) && waitForArrival(arrival)) {
+                arrived++;
+                drive(arrival);
+            }
+            if (--active_workers == 0) {
+                dispatch_done = true;
+            }
+        };
+        try {
+            for (int w = 0; w < options.workers; ++w) {
+                workers.emplace_back(worker);
+            }
+        } catch (const std::system_error& e) {
+            // Работаем с теми потоками, которые удалось создать
+            int missing = options.workers - static_cast<int>(workers.size());
+            if (workers.empty()) {
+                launch_error = std::string("не удалось создать поток пула: ") + e.what();
+            } else {
+                std::cerr << "Предупреждение: создано только " << workers.size() << " потоков пула из "
+                          << options.workers << std::endl;
+            }
+            if ((active_workers -= missing) == 0) {
+                dispatch_done = true;
+            }
+        }
+    } else {
+        // Поток на машину: диспетчер запускает отсоединенные потоки по расписанию,
+        // чтобы завершившиеся потоки не накапливались до конца прогона. Одновременно
+        // живет не больше max_threads потоков: следующая машина ждет, пока кто-то уедет
+        workers.emplace_back([&]() {
+            Arrival arrival;
+            while (launch_error.empty() && generator.next(arrival) && waitForArrival(arrival)) {
+                while (arrived - finished >= options.max_threads && !pastDeadline()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                while (!pastDeadline()) {
+                    arrived++;
+                    try {
+                        std::thread(drive, arrival).detach();
+                        break;
+                    } catch (const std::system_error& e) {
+                        // Система не дает создать поток: ждем, пока освободится хотя бы один,
+                        // а если ждать некого - прекращаем подачу
+                        arrived--;
+                        long long in_flight = arrived - finished;
+                        if (in_flight == 0) {
+                            launch_error = std::string("не удалось создать поток машины: ") + e.what();
+                            break;
+                        }
+                        while (arrived - finished >= in_flight && !pastDeadline()) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                    }
+                }
+            }
+            dispatch_done = true;
+        });
+    }
+
+    if (options.format == "csv") {
+        std::cout << "kind,elapsed_ms,planned,arrived,crossed,in_flight,throughput,"
+                  << "wait_p99_ms,wait_max_ms,switches,north_batch,south_batch" << std::endl;
+    } else if (options.format == "human") {
+        std::cout << "=== МОДЕЛИРОВАНИЕ УЗКОГО МОСТА (неинтерактивный режим) ===" << std::endl;
+        std::cout << "Количество машин: " << options.num_cars
+                  << ", прибытие: " << options.arrival
+                  << ", режим: " << options.mode
+                  << (options.fifo ? " (FIFO)" : "")
+                  << ", seed: " << seed << std::endl;
+    }
+
+    // Главный поток не блокируется на join, а периодически печатает прогресс
+    auto elapsedMs = [&start_time]() {
+        return static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_time).count());
+    };
+    auto makeReport = [&](const char* kind) {
+        RunReport report;
+        report.kind = kind;
+        report.elapsed_ms = elapsedMs();
+        report.arrived = arrived.load();
+        report.crossed = finished.load();
+        report.planned = options.num_cars;
+        report.wait_p99_ms = bridge.getWaitTimes().percentileMs(0.99);
+        report.wait_max_ms = bridge.getWaitTimes().maxMs();
+        report.switches = bridge.getDirectionSwitches();
+        if (options.adaptive) {
+            SwitchControllerMetrics metrics = controller.metrics();
+            report.north_batch = metrics.north_batch;
+            report.south_batch = metrics.south_batch;
+        } else {
+            report.north_batch = options.max_batch;
+            report.south_batch = options.max_batch;
+        }
+        return report;
+    };
+    auto next_report = start_time + std::chrono::milliseconds(options.progress_ms);
+    while (!(dispatch_done && finished == arrived)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (options.progress_ms > 0 && std::chrono::steady_clock::now() >= next_report) {
+            printReport(options, makeReport("progress"));
+            next_report += std::chrono::milliseconds(options.progress_ms);
+        }
+    }
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    RunReport summary = makeReport("summary");
+    printReport(options, summary);
+    if (!launch_error.empty()) {
+        std::cerr << "Ошибка: " << launch_error << std::endl;
+        return 1;
+    }
+
+    // Успех: все поданные машины переехали, и без ограничения времени поданы все машины
+    bool success = bridge.allCarsCrossedSuccessfully() &&
+                   bridge.getSuccessfulCrossings() == summary.arrived &&
+                   (has_deadline || summary.arrived == options.num_cars);
+    if (options.format == "human") {
+        if (success) {
+            std::cout << "УСПЕХ: Все " << summary.crossed << " машин успешно переехали мост!" << std::endl;
+        } else {
+            std::cout << "ОШИБКА: Переехало только " << summary.crossed << " из " << summary.arrived << " машин" << std::endl;
+        }
+    }
+    return success ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    // При наличии параметров командной строки работаем без интерактивного ввода
+    if (argc > 1) {
+        RunOptions options;
+        std::string error;
+        for (int i = 1; i < argc; ++i) {
+            if (std::string(argv[i]) == "--help" || std::string(argv[i]) == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            }
+        }
+        if (!parseArguments(argc, argv, options, error)) {
+            std::cerr << "Ошибка: " << error << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        }
+        return runHeadless(options);
+    }
+
     // Создаем объект моста
     NarrowBridge bridge;
     // Получаем количество машин от пользователя
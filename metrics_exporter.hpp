@@ -0,0 +1,244 @@
+#ifndef METRICS_EXPORTER_HPP
+#define METRICS_EXPORTER_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "narrow_bridge.hpp"
+
+// Фоновый экспорт метрик моста в текстовом формате Prometheus.
+// Слушает Unix-сокет или порт на localhost и на каждое подключение отвечает
+// HTTP/1.0 с текущими значениями. Метрики читаются через snapshot() и атомарную
+// гистограмму ожидания, поэтому опрос не захватывает мьютекс моста.
+class MetricsExporter {
+private:
+    const NarrowBridge& bridge;
+    std::string unix_path;          // Путь Unix-сокета, созданного этим экспортером (пусто - TCP)
+    dev_t socket_dev = 0;           // Устройство и inode созданного сокета: при остановке
+    ino_t socket_ino = 0;           // удаляется, только если по пути лежит он же
+    int listen_fd = -1;
+    std::atomic<bool> stopping{false};
+    std::thread server;
+
+public:
+    // address: "unix:/путь/к/сокету" или номер порта на 127.0.0.1 ("9100")
+    MetricsExporter(const NarrowBridge& bridge_to_export, const std::string& address)
+        : bridge(bridge_to_export) {
+        if (address.compare(0, 5, "unix:") == 0) {
+            listenUnix(address.substr(5));
+        } else {
+            listenTcp(address);
+        }
+        server = std::thread(&MetricsExporter::serve, this);
+    }
+
+    ~MetricsExporter() {
+        stopping = true;
+        if (server.joinable()) {
+            server.join();
+        }
+        close(listen_fd);
+        struct stat info;
+        if (!unix_path.empty() && lstat(unix_path.c_str(), &info) == 0 &&
+            info.st_dev == socket_dev && info.st_ino == socket_ino) {
+            unlink(unix_path.c_str());
+        }
+    }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Текст метрик в формате Prometheus exposition 0.0.4
+    static std::string render(const NarrowBridge& bridge) {
+        BridgeSnapshot snapshot = bridge.snapshot();
+        std::ostringstream out;
+
+        out << "# HELP narrow_bridge_cars_waiting Машины, ожидающие въезда.\n"
+            << "# TYPE narrow_bridge_cars_waiting gauge\n"
+            << "narrow_bridge_cars_waiting{direction=\"north\"} " << snapshot.north_cars_waiting << "\n"
+            << "narrow_bridge_cars_waiting{direction=\"south\"} " << snapshot.south_cars_waiting << "\n";
+        out << "# HELP narrow_bridge_cars_on_bridge Машины на мосту.\n"
+            << "# TYPE narrow_bridge_cars_on_bridge gauge\n"
+            << "narrow_bridge_cars_on_bridge{direction=\"north\"} " << snapshot.north_cars_on_bridge << "\n"
+            << "narrow_bridge_cars_on_bridge{direction=\"south\"} " << snapshot.south_cars_on_bridge << "\n";
+        out << "# HELP narrow_bridge_arrivals_total Машины, подъехавшие к мосту.\n"
+            << "# TYPE narrow_bridge_arrivals_total counter\n"
+            << "narrow_bridge_arrivals_total " << snapshot.total_cars << "\n";
+        out << "# HELP narrow_bridge_crossings_total Завершенные переезды.\n"
+            << "# TYPE narrow_bridge_crossings_total counter\n"
+            << "narrow_bridge_crossings_total " << snapshot.successful_crossings << "\n";
+        out << "# HELP narrow_bridge_direction_switches_total Смены направления движения.\n"
+            << "# TYPE narrow_bridge_direction_switches_total counter\n"
+            << "narrow_bridge_direction_switches_total " << snapshot.direction_switches << "\n";
+
+        // Корзины читаются по одной; _count считается по ним же, чтобы гистограмма
+        // была согласована сама с собой
+        const WaitHistogram& waits = bridge.getWaitTimes();
+        out << "# HELP narrow_bridge_wait_seconds Время ожидания перед въездом.\n"
+            << "# TYPE narrow_bridge_wait_seconds histogram\n";
+        long long cumulative = 0;
+        for (int i = 0; i < WaitHistogram::BUCKET_COUNT; ++i) {
+            cumulative += waits.bucketCount(i);
+            out << "narrow_bridge_wait_seconds_bucket{le=\"" << formatDouble(WaitHistogram::bucketBoundUs(i) / 1e6)
+                << "\"} " << cumulative << "\n";
+        }
+        cumulative += waits.bucketCount(WaitHistogram::BUCKET_COUNT);
+        out << "narrow_bridge_wait_seconds_bucket{le=\"+Inf\"} " << cumulative << "\n"
+            << "narrow_bridge_wait_seconds_sum " << formatDouble(waits.sumMs() / 1000.0) << "\n"
+            << "narrow_bridge_wait_seconds_count " << cumulative << "\n";
+
+        const AdaptiveSwitchController* controller = bridge.getSwitchController();
+        if (controller) {
+            SwitchControllerMetrics metrics = controller->metrics();
+            out << "# HELP narrow_bridge_batch_limit Лимит пачки, выбранный адаптивным контроллером.\n"
+                << "# TYPE narrow_bridge_batch_limit gauge\n"
+                << "narrow_bridge_batch_limit{direction=\"north\"} " << metrics.north_batch << "\n"
+                << "narrow_bridge_batch_limit{direction=\"south\"} " << metrics.south_batch << "\n";
+            out << "# HELP narrow_bridge_window_wait_p99_seconds p99 ожидания в окне контроллера.\n"
+                << "# TYPE narrow_bridge_window_wait_p99_seconds gauge\n"
+                << "narrow_bridge_window_wait_p99_seconds{direction=\"north\"} "
+                << formatDouble(metrics.north_p99_ms / 1000.0) << "\n"
+                << "narrow_bridge_window_wait_p99_seconds{direction=\"south\"} "
+                << formatDouble(metrics.south_p99_ms / 1000.0) << "\n";
+            out << "# HELP narrow_bridge_arrival_rate Интенсивность прибытия в окне контроллера, машин/с.\n"
+                << "# TYPE narrow_bridge_arrival_rate gauge\n"
+                << "narrow_bridge_arrival_rate{direction=\"north\"} " << formatDouble(metrics.north_rate) << "\n"
+                << "narrow_bridge_arrival_rate{direction=\"south\"} " << formatDouble(metrics.south_rate) << "\n";
+            out << "# HELP narrow_bridge_controller_adjustments_total Пересчеты лимитов контроллером.\n"
+                << "# TYPE narrow_bridge_controller_adjustments_total counter\n"
+                << "narrow_bridge_controller_adjustments_total " << metrics.adjustments << "\n";
+        }
+        return out.str();
+    }
+
+private:
+    static std::string formatDouble(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+        return buffer;
+    }
+
+    void listenUnix(const std::string& path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("некорректный путь Unix-сокета: " + path);
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+        }
+        // Удаляется только сокет, оставшийся от предыдущего запуска; любой другой
+        // файл по этому пути - скорее всего опечатка, и трогать его нельзя
+        struct stat info;
+        if (lstat(path.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                close(listen_fd);
+                throw std::runtime_error("путь " + path + " занят и не является сокетом");
+            }
+            unlink(path.c_str());
+        }
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd, 16) != 0) {
+            int error = errno;
+            close(listen_fd);
+            throw std::runtime_error("не удалось открыть " + path + ": " + std::strerror(error));
+        }
+        if (lstat(path.c_str(), &info) == 0) {
+            socket_dev = info.st_dev;
+            socket_ino = info.st_ino;
+            unix_path = path;
+        }
+    }
+
+    void listenTcp(const std::string& port_text) {
+        char* end = nullptr;
+        long port = std::strtol(port_text.c_str(), &end, 10);
+        if (port_text.empty() || *end != '\0' || port < 1 || port > 65535) {
+            throw std::runtime_error("некорректный порт метрик: " + port_text);
+        }
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+        }
+        int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd, 16) != 0) {
+            int error = errno;
+            close(listen_fd);
+            throw std::runtime_error("не удалось открыть порт " + port_text + ": " + std::strerror(error));
+        }
+    }
+
+    // Цикл сервера: poll с таймаутом, чтобы деструктор мог остановить поток
+    void serve() {
+        while (!stopping) {
+            pollfd listener = {listen_fd, POLLIN, 0};
+            if (poll(&listener, 1, 100) <= 0) {
+                continue;
+            }
+            int client = accept(listen_fd, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            respond(client);
+            close(client);
+        }
+    }
+
+    void respond(int client) {
+        // Запрос читается только для того, чтобы клиент не получил сброс соединения;
+        // путь не важен - любой запрос получает метрики
+        pollfd request = {client, POLLIN, 0};
+        if (poll(&request, 1, 500) > 0) {
+            char buffer[4096];
+            ssize_t ignored = recv(client, buffer, sizeof(buffer), 0);
+            (void)ignored;
+        }
+
+        std::string body = render(bridge);
+        std::ostringstream response;
+        response << "HTTP/1.0 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        std::string data = response.str();
+
+        size_t sent = 0;
+        while (sent < data.size()) {
+            // MSG_NOSIGNAL: клиент, закрывший соединение, не должен завершать процесс SIGPIPE
+            ssize_t written = send(client, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0) {
+                return;
+            }
+            sent += static_cast<size_t>(written);
+        }
+    }
+};
+
+#endif
@@ -10,115 +10,387 @@
 #include <random>
 #include <atomic>
 #include <string>
+#include <functional>
+#include "wait_histogram.hpp"
+#include "switch_controller.hpp"
+
+// Параметры моделирования моста
+struct BridgeConfig {
+    // Печатать ли сообщения о каждой машине (для нагрузочных прогонов отключается)
+    bool verbose = true;
+    // Фиксированное время переезда в мс; -1 - исходная модель 500 + car_id % 300 мс
+    int crossing_time_ms = -1;
+    // Сколько машин подряд может въехать в одном направлении, пока с другой стороны
+    // ждут (0 - без ограничения, как в исходной модели)
+    int max_batch = 0;
+    // Адаптивный контроллер длины пачки; если задан, заменяет max_batch
+    AdaptiveSwitchController* switch_controller = nullptr;
+    // Очередь FIFO с передачей права проезда: машины одного направления въезжают строго
+    // в порядке прибытия, и уезжающая машина будит только тех, кому пора ехать
+    bool fifo_handoff = false;
+    // Необязательный обработчик въезда. Вызывается под мьютексом моста в потоке самой
+    // въезжающей машины (в режиме FIFO - после того, как машина проснулась)
+    std::function<void(int car_id, const std::string& direction)> on_admit;
+};
+
+// Снимок счетчиков моста, снятый без захвата мьютекса. Поля читаются по отдельности,
+// поэтому между ними возможны расхождения в одну-две машины
+struct BridgeSnapshot {
+    int north_cars_waiting;
+    int south_cars_waiting;
+    int north_cars_on_bridge;
+    int south_cars_on_bridge;
+    int successful_crossings;
+    int total_cars;
+    int direction_switches;
+};
 
 // Класс для моделирования узкого моста
 class NarrowBridge {
 private:
+    // Мьютекс для синхронизации доступа к общим данным
     std::mutex mtx;
+    // Условная переменная для координации между потоками
     std::condition_variable cv;
-    
-    int north_cars_on_bridge = 0;
-    int south_cars_on_bridge = 0;
-    int north_cars_waiting = 0;
-    int south_cars_waiting = 0;
-    std::string current_direction = "НЕТ";
-    
-    std::atomic<int> successful_crossings{0};
-    std::atomic<int> total_cars{0};
+
+    // Параметры моделирования
+    BridgeConfig config;
+
+    // Счетчики машин на мосту (меняются под мьютексом, атомарные - для snapshot())
+    std::atomic<int> north_cars_on_bridge{0};    // Машины с севера на мосту
+    std::atomic<int> south_cars_on_bridge{0};    // Машины с юга на мосту
+    // Счетчики ожидающих машин (аналогично)
+    std::atomic<int> north_cars_waiting{0};      // Машины с севера, ожидающие проезда
+    std::atomic<int> south_cars_waiting{0};      // Машины с юга, ожидающие проезда
+    // Текущее разрешенное направление движения
+    std::string current_direction = "НЕТ"; // "СЕВЕР", "ЮГ", "НЕТ"
+    // Направление последней въехавшей машины (для подсчета смен направления)
+    std::string last_direction = "НЕТ";
+    // Сколько машин въехало подряд в текущем направлении
+    int batch_admitted = 0;
+
+    // Ожидающая машина в режиме FIFO. Узел живет на стеке потока машины и занимает
+    // свою кэш-линию: машина ждет только на собственном флаге, не задевая соседей
+    struct alignas(64) Waiter {
+        std::atomic<bool> granted{false}; // Право проезда передано
+        std::mutex park_mtx;              // Для засыпания после короткого ожидания в цикле
+        std::condition_variable park_cv;
+        Waiter* next = nullptr;
+    };
+    // Интрузивные очереди ожидающих по направлениям: [0] - север, [1] - юг
+    Waiter* queue_head[2] = {nullptr, nullptr};
+    Waiter* queue_tail[2] = {nullptr, nullptr};
+
+    // Атомарные счетчики для статистики (не требуют мьютекса)
+    std::atomic<int> successful_crossings{0}; // Успешные переезды
+    std::atomic<int> total_cars{0};           // Общее количество машин
+    std::atomic<int> direction_switches{0};   // Смены направления движения
+    WaitHistogram wait_times;                 // Время ожидания перед въездом
 
 public:
+    NarrowBridge() {}
+
+    explicit NarrowBridge(const BridgeConfig& bridge_config) : config(bridge_config) {}
+
+    // Метод для машины, подъезжающей с севера
     void arriveFromNorth(int car_id) {
-        total_cars++;
-        
-        {
-            std::unique_lock<std::mutex> lock(mtx);
-            north_cars_waiting++;
-            std::cout << "Машина " << car_id << " с СЕВЕРА подъехала к мосту. Ожидание..." << std::endl;
-            
-            cv.wait(lock, [this]() {
-                return south_cars_on_bridge == 0 && 
-                       (current_direction == "СЕВЕР" || current_direction == "НЕТ");
-            });
-            
-            north_cars_waiting--;
-            north_cars_on_bridge++;
-            current_direction = "СЕВЕР";
-            
-            std::cout << "Машина " << car_id << " с СЕВЕРА начала переезд. На мосту: " 
-                      << north_cars_on_bridge << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
-        }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(500 + car_id % 300));
-        leaveBridge(car_id, "СЕВЕР");
+        arrive(car_id, "СЕВЕР");
     }
-    
+
+    // Метод для машины, подъезжающей с юга (аналогично северу)
     void arriveFromSouth(int car_id) {
-        total_cars++;
-        {
-            std::unique_lock<std::mutex> lock(mtx);
-            south_cars_waiting++;
-            std::cout << "Машина " << car_id << " с ЮГА подъехала к мосту. Ожидание..." << std::endl;
-            
-            cv.wait(lock, [this]() {
-                return north_cars_on_bridge == 0 && 
-                       (current_direction == "ЮГ" || current_direction == "НЕТ");
-            });
-            
-            south_cars_waiting--;
-            south_cars_on_bridge++;
-            current_direction = "ЮГ";
-            
-            std::cout << "Машина " << car_id << " с ЮГА начала переезд. На мосту: " 
-                      << north_cars_on_bridge << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
-        }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(500 + car_id % 300));
-        leaveBridge(car_id, "ЮГ");
+        arrive(car_id, "ЮГ");
     }
-    
+
+    // Варианты с заданным моментом прибытия: ожидание отсчитывается от него, а не от
+    // вызова (например, от момента по расписанию, если машину подали с опозданием)
+    void arriveFromNorthAt(int car_id, std::chrono::steady_clock::time_point arrived_at) {
+        arrive(car_id, "СЕВЕР", arrived_at);
+    }
+
+    void arriveFromSouthAt(int car_id, std::chrono::steady_clock::time_point arrived_at) {
+        arrive(car_id, "ЮГ", arrived_at);
+    }
+
+    // Геттеры для получения статистики
     int getSuccessfulCrossings() const {
         return successful_crossings.load();
     }
-    
+
     int getTotalCars() const {
         return total_cars.load();
     }
-    
+
     bool allCarsCrossedSuccessfully() const {
         return successful_crossings == total_cars;
     }
 
+    int getDirectionSwitches() const {
+        return direction_switches.load();
+    }
+
+    const WaitHistogram& getWaitTimes() const {
+        return wait_times;
+    }
+
+    // Текущее состояние для мониторинга; не конкурирует с машинами за мьютекс
+    BridgeSnapshot snapshot() const {
+        BridgeSnapshot result;
+        result.north_cars_waiting = north_cars_waiting.load(std::memory_order_relaxed);
+        result.south_cars_waiting = south_cars_waiting.load(std::memory_order_relaxed);
+        result.north_cars_on_bridge = north_cars_on_bridge.load(std::memory_order_relaxed);
+        result.south_cars_on_bridge = south_cars_on_bridge.load(std::memory_order_relaxed);
+        result.successful_crossings = successful_crossings.load(std::memory_order_relaxed);
+        result.total_cars = total_cars.load(std::memory_order_relaxed);
+        result.direction_switches = direction_switches.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    // Адаптивный контроллер моста (nullptr, если не задан)
+    const AdaptiveSwitchController* getSwitchController() const {
+        return config.switch_controller;
+    }
+
 private:
+    // Общая логика въезда для обоих направлений
+    void arrive(int car_id, const std::string& direction) {
+        arrive(car_id, direction, std::chrono::steady_clock::now());
+    }
+
+    void arrive(int car_id, const std::string& direction, std::chrono::steady_clock::time_point arrived_at) {
+        total_cars++; // Увеличиваем общий счетчик машин
+
+        if (config.fifo_handoff) {
+            arriveFifo(car_id, direction, arrived_at);
+        } else {
+            // Захватываем мьютекс для работы с общими данными
+            std::unique_lock<std::mutex> lock(mtx);
+            registerArrival(car_id, direction, arrived_at);
+
+            // Ждем, пока можно будет проехать
+            cv.wait(lock, [this, &direction]() {
+                return canEnter(direction);
+            });
+
+            // Условие выполнено - машина может ехать
+            admit(direction);
+            recordAdmission(car_id, direction, arrived_at);
+        } // Мьютекс автоматически освобождается при выходе из блока
+
+        // Имитация времени переезда (мьютекс не захвачен - другие машины могут подъезжать)
+        cross(car_id);
+
+        // Завершаем переезд
+        leaveBridge(car_id, direction);
+    }
+
+    // Въезд в режиме FIFO: если очередь направления пуста и въезд разрешен, машина
+    // едет сразу, иначе встает в хвост и ждет, пока право проезда передадут ей
+    void arriveFifo(int car_id, const std::string& direction,
+                    std::chrono::steady_clock::time_point arrived_at) {
+        Waiter waiter;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            registerArrival(car_id, direction, arrived_at);
+
+            int d = direction == "СЕВЕР" ? 0 : 1;
+            if (queue_head[d] == nullptr && canEnter(direction)) {
+                admit(direction);
+                recordAdmission(car_id, direction, arrived_at);
+                return;
+            }
+
+            if (queue_tail[d]) {
+                queue_tail[d]->next = &waiter;
+            } else {
+                queue_head[d] = &waiter;
+            }
+            queue_tail[d] = &waiter;
+        }
+
+        // Короткое ожидание в цикле на своем флаге, затем засыпание
+        for (int spin = 0; spin < 64 && !waiter.granted.load(std::memory_order_acquire); ++spin) {
+            std::this_thread::yield();
+        }
+        {
+            std::unique_lock<std::mutex> park_lock(waiter.park_mtx);
+            waiter.park_cv.wait(park_lock, [&waiter]() {
+                return waiter.granted.load(std::memory_order_acquire);
+            });
+        } // После этого передающий поток уже не обращается к узлу
+
+        // Машина уже допущена; ожидание фиксируется в ее собственном потоке после
+        // пробуждения, как и в режиме с условной переменной
+        std::unique_lock<std::mutex> lock(mtx);
+        recordAdmission(car_id, direction, arrived_at);
+    }
+
+    // Учет подъехавшей машины (вызывается под мьютексом)
+    void registerArrival(int car_id, const std::string& direction,
+                         std::chrono::steady_clock::time_point arrived_at) {
+        const bool from_north = direction == "СЕВЕР";
+        std::atomic<int>& cars_waiting = from_north ? north_cars_waiting : south_cars_waiting;
+        cars_waiting++; // Увеличиваем счетчик ожидающих
+        if (config.switch_controller) {
+            config.switch_controller->onArrival(direction, arrived_at);
+        }
+        if (config.verbose) {
+            std::cout << "Машина " << car_id << " с " << (from_north ? "СЕВЕРА" : "ЮГА")
+                      << " подъехала к мосту. Ожидание..." << std::endl;
+        }
+    }
+
+    // Въезд машины на мост (вызывается под мьютексом, когда canEnter вернул true)
+    void admit(const std::string& direction) {
+        const bool from_north = direction == "СЕВЕР";
+        std::atomic<int>& cars_waiting = from_north ? north_cars_waiting : south_cars_waiting;
+        std::atomic<int>& cars_on_bridge = from_north ? north_cars_on_bridge : south_cars_on_bridge;
+
+        cars_waiting--;    // Уменьшаем счетчик ожидающих
+        cars_on_bridge++;  // Увеличиваем счетчик на мосту
+        if (current_direction != direction) {
+            batch_admitted = 0; // Новая пачка в этом направлении
+        }
+        if (last_direction != direction && last_direction != "НЕТ") {
+            direction_switches++;
+        }
+        current_direction = direction; // Устанавливаем направление движения
+        last_direction = direction;
+        batch_admitted++;
+    }
+
+    // Учет допуска в потоке самой машины (вызывается под мьютексом): время ожидания,
+    // контроллер и обработчик въезда
+    void recordAdmission(int car_id, const std::string& direction,
+                         std::chrono::steady_clock::time_point arrived_at) {
+        const bool from_north = direction == "СЕВЕР";
+        auto admitted_at = std::chrono::steady_clock::now();
+        auto waited = std::chrono::duration_cast<std::chrono::microseconds>(admitted_at - arrived_at);
+        wait_times.record(waited);
+        if (config.switch_controller) {
+            config.switch_controller->onAdmission(direction, waited, admitted_at);
+            config.switch_controller->update(north_cars_waiting, south_cars_waiting, admitted_at);
+        }
+        if (config.on_admit) {
+            config.on_admit(car_id, direction);
+        }
+
+        if (config.verbose) {
+            std::cout << "Машина " << car_id << " с " << (from_north ? "СЕВЕРА" : "ЮГА") << " начала переезд. На мосту: "
+                      << north_cars_on_bridge << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
+        }
+    }
+
+    // Передача права проезда головам очередей FIFO (вызывается под мьютексом).
+    // Будятся только допущенные машины, по одной на узел, без общего notify_all
+    void grantWaiters() {
+        // Сначала текущее направление, чтобы не разрывать его пачку
+        int first = current_direction == "ЮГ" ? 1 : 0;
+        for (int k = 0; k < 2; ++k) {
+            int d = (first + k) % 2;
+            const std::string direction = d == 0 ? "СЕВЕР" : "ЮГ";
+            while (queue_head[d] && canEnter(direction)) {
+                Waiter* waiter = queue_head[d];
+                queue_head[d] = waiter->next;
+                if (queue_head[d] == nullptr) {
+                    queue_tail[d] = nullptr;
+                }
+
+                admit(direction);
+
+                std::lock_guard<std::mutex> park_lock(waiter->park_mtx);
+                waiter->granted.store(true, std::memory_order_release);
+                waiter->park_cv.notify_one();
+            }
+        }
+    }
+
+    // Условие въезда (вызывается под мьютексом):
+    // на мосту нет встречных машин, направление разрешено, и пачка не исчерпана,
+    // если с другой стороны кто-то ждет
+    bool canEnter(const std::string& direction) const {
+        const bool from_north = direction == "СЕВЕР";
+        int oncoming_on_bridge = from_north ? south_cars_on_bridge : north_cars_on_bridge;
+        int oncoming_waiting = from_north ? south_cars_waiting : north_cars_waiting;
+
+        if (oncoming_on_bridge != 0) {
+            return false;
+        }
+        if (current_direction == "НЕТ") {
+            return true;
+        }
+        if (current_direction != direction) {
+            return false;
+        }
+
+        int limit = config.switch_controller ? config.switch_controller->batchLimit(direction)
+                                             : config.max_batch;
+        return limit <= 0 || oncoming_waiting == 0 || batch_admitted < limit;
+    }
+
+    // Имитация переезда: время задается конфигурацией или исходной моделью
+    void cross(int car_id) const {
+        int crossing_ms = config.crossing_time_ms >= 0 ? config.crossing_time_ms : 500 + car_id % 300;
+        if (crossing_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(crossing_ms));
+        }
+    }
+
+    // Приватный метод для завершения переезда
     void leaveBridge(int car_id, const std::string& direction) {
+        // Захватываем мьютекс для изменения общих данных
         std::unique_lock<std::mutex> lock(mtx);
-        
+
+        // Уменьшаем счетчик машин на мосту в зависимости от направления
         if (direction == "СЕВЕР") {
             north_cars_on_bridge--;
         } else {
             south_cars_on_bridge--;
         }
-        
+
+        // Увеличиваем счетчик успешных переездов
         successful_crossings++;
-        
+
+        if (config.switch_controller) {
+            config.switch_controller->update(north_cars_waiting, south_cars_waiting,
+                                             std::chrono::steady_clock::now());
+        }
+
+        // Если все машины уехали с моста в текущем направлении
         if (north_cars_on_bridge == 0 && south_cars_on_bridge == 0) {
+            // Мост освободился - следующая пачка начинается заново
+            batch_admitted = 0;
+            // Решаем, какое направление будет следующим
             if (direction == "СЕВЕР" && south_cars_waiting > 0) {
+                // Если только что ехали с севера и есть ожидающие с юга - разрешаем юг
                 current_direction = "ЮГ";
             } else if (direction == "ЮГ" && north_cars_waiting > 0) {
+                // Если только что ехали с юга и есть ожидающие с севера - разрешаем север
                 current_direction = "СЕВЕР";
             } else {
+                // Если ожидающих нет - мост свободен
                 current_direction = "НЕТ";
             }
         }
-        
-        std::cout << "Машина " << car_id << " с " << (direction == "СЕВЕР" ? "СЕВЕРА" : "ЮГА") 
-                  << " переехала мост. На мосту осталось: " << north_cars_on_bridge 
-                  << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
-        std::cout << "Текущее направление: " << current_direction 
-                  << ", Ожидают: " << north_cars_waiting << " с севера, " 
-                  << south_cars_waiting << " с юга" << std::endl;
-        
-        cv.notify_all();
+
+        // Выводим информацию о завершении переезда
+        if (config.verbose) {
+            std::cout << "Машина " << car_id << " с " << (direction == "СЕВЕР" ? "СЕВЕРА" : "ЮГА")
+                      << " переехала мост. На мосту осталось: " << north_cars_on_bridge
+                      << " с севера, " << south_cars_on_bridge << " с юга" << std::endl;
+            std::cout << "Текущее направление: " << current_direction
+                      << ", Ожидают: " << north_cars_waiting << " с севера, "
+                      << south_cars_waiting << " с юга" << std::endl;
+        }
+
+        if (config.fifo_handoff) {
+            // Передаем право проезда следующим по очереди
+            grantWaiters();
+        } else {
+            // Уведомляем все ожидающие потоки, что состояние изменилось
+            cv.notify_all();
+        }
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,519 @@
+#ifndef SHARED_BRIDGE_HPP
+#define SHARED_BRIDGE_HPP
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <stdexcept>
+#include <new>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "narrow_bridge.hpp"
+
+// Узкий мост, состояние которого лежит в разделяемой памяти POSIX.
+// Независимые процессы одного хоста открывают сегмент по имени и согласуют проезд
+// через межпроцессный (PTHREAD_PROCESS_SHARED) мьютекс и счетчик пробуждений на futex.
+// Условная переменная pthread здесь не годится: ожидающий, убитый внутри
+// pthread_cond_wait, оставляет в ней свою ссылку, и следующий broadcast зависает,
+// удерживая мьютекс моста. Счетчик пробуждений не хранит состояния ожидающих,
+// поэтому гибель ожидающего процесса на него не влияет.
+//
+// Устойчивость к падению процессов:
+// - каждый процесс занимает слот со своими счетчиками машин на мосту и в очереди и
+//   все время работы держит робастный мьютекс "жизни" слота. Если процесс умер,
+//   попытка захвата этого мьютекса другим процессом вернет EOWNERDEAD - в том числе
+//   пока умерший процесс остается зомби и его pid еще существует;
+// - ожидающие периодически просыпаются и списывают машины умерших процессов, поэтому
+//   мост не блокируется машиной, "умершей" посреди переезда или в очереди;
+// - общий мьютекс тоже робастный. Процесс мог умереть между парными изменениями
+//   общих счетчиков и счетчиков слота, поэтому при восстановлении общие счетчики не
+//   уменьшаются, а пересчитываются заново по слотам живых процессов.
+//
+// Из BridgeConfig поддерживаются verbose, crossing_time_ms, max_batch и on_admit;
+// адаптивный контроллер живет в памяти процесса и здесь не используется.
+class SharedNarrowBridge {
+public:
+    static const int MAX_PROCESSES = 64;
+
+private:
+    // Направления хранятся числами: std::string нельзя класть в разделяемую память
+    enum Direction { NONE = 0, NORTH = 1, SOUTH = 2 };
+
+    // Слот процесса-участника
+    struct ProcessSlot {
+        pthread_mutex_t alive;  // Захвачен, пока процесс-владелец жив
+        pid_t pid;              // 0 - слот свободен
+        int cars_on_bridge[3];  // Машины процесса на мосту по направлениям
+        int cars_waiting[3];    // Машины процесса в очереди по направлениям
+    };
+
+    // Состояние моста в сегменте разделяемой памяти
+    struct SharedState {
+        std::atomic<unsigned int> ready;  // Признак завершенной инициализации
+        pthread_mutex_t mtx;
+        std::atomic<unsigned int> wake_seq; // Счетчик пробуждений (слово futex)
+
+        int cars_on_bridge[3];
+        int cars_waiting[3];
+        int current_direction;
+        int last_direction;
+        int batch_admitted;
+
+        std::atomic<int> successful_crossings;
+        std::atomic<int> total_cars;
+        std::atomic<int> direction_switches;
+        std::atomic<int> recovered_cars;   // Машины, списанные за умершими процессами
+        WaitHistogram wait_times;
+
+        ProcessSlot slots[MAX_PROCESSES];
+    };
+
+    static const unsigned int READY_MAGIC = 0x4E425247; // "NBRG"
+
+    BridgeConfig config;
+    std::string name;
+    SharedState* state = nullptr;
+    int slot = -1;
+
+    // Робастный мьютекс принадлежит потоку, а не процессу, поэтому мьютекс жизни слота
+    // держит отдельный поток: он живет ровно столько, сколько объект моста в процессе
+    std::thread liveness_holder;
+    std::mutex holder_mtx;
+    std::condition_variable holder_cv;
+    bool holder_locked = false;
+    bool holder_stop = false;
+
+public:
+    // Открывает сегмент name (например, "/narrow_bridge"), создавая его при отсутствии
+    explicit SharedNarrowBridge(const std::string& segment_name, const BridgeConfig& bridge_config = BridgeConfig())
+        : config(bridge_config), name(segment_name) {
+        bool created = true;
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0 && errno == EEXIST) {
+            created = false;
+            fd = shm_open(name.c_str(), O_RDWR, 0600);
+        }
+        if (fd < 0) {
+            throw std::runtime_error("shm_open(" + name + "): " + std::strerror(errno));
+        }
+
+        if (created && ftruncate(fd, sizeof(SharedState)) != 0) {
+            int error = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::runtime_error("ftruncate(" + name + "): " + std::strerror(error));
+        }
+        if (!created) {
+            waitForSize(fd);
+        }
+
+        void* memory = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED) {
+            throw std::runtime_error("mmap(" + name + "): " + std::strerror(errno));
+        }
+        state = static_cast<SharedState*>(memory);
+
+        if (created) {
+            initialize();
+        } else {
+            waitForReady();
+        }
+        registerProcess();
+    }
+
+    ~SharedNarrowBridge() {
+        if (state) {
+            if (slot >= 0) {
+                lock();
+                ProcessSlot& own = state->slots[slot];
+                stopLivenessHolder();
+                // Слот освобождается, только если машин этого процесса на мосту нет;
+                // иначе другие процессы увидят свободный мьютекс жизни и спишут машины
+                if (own.cars_on_bridge[NORTH] + own.cars_on_bridge[SOUTH] +
+                    own.cars_waiting[NORTH] + own.cars_waiting[SOUTH] == 0) {
+                    own.pid = 0;
+                }
+                pthread_mutex_unlock(&state->mtx);
+            }
+            munmap(state, sizeof(SharedState));
+        }
+    }
+
+    SharedNarrowBridge(const SharedNarrowBridge&) = delete;
+    SharedNarrowBridge& operator=(const SharedNarrowBridge&) = delete;
+
+    // Удаление сегмента; процессы, уже открывшие его, продолжают работать
+    static void remove(const std::string& segment_name) {
+        shm_unlink(segment_name.c_str());
+    }
+
+    // Метод для машины, подъезжающей с севера
+    void arriveFromNorth(int car_id) {
+        arrive(car_id, NORTH);
+    }
+
+    // Метод для машины, подъезжающей с юга
+    void arriveFromSouth(int car_id) {
+        arrive(car_id, SOUTH);
+    }
+
+    // Геттеры для получения статистики (общей для всех процессов)
+    int getSuccessfulCrossings() const {
+        return state->successful_crossings.load();
+    }
+
+    int getTotalCars() const {
+        return state->total_cars.load();
+    }
+
+    // Машины, списанные при восстановлении, тоже считаются завершенными
+    bool allCarsCrossedSuccessfully() const {
+        return state->successful_crossings + state->recovered_cars == state->total_cars;
+    }
+
+    int getDirectionSwitches() const {
+        return state->direction_switches.load();
+    }
+
+    int getRecoveredCars() const {
+        return state->recovered_cars.load();
+    }
+
+    const WaitHistogram& getWaitTimes() const {
+        return state->wait_times;
+    }
+
+    int getCarsOnBridge() {
+        lock();
+        int cars = state->cars_on_bridge[NORTH] + state->cars_on_bridge[SOUTH];
+        pthread_mutex_unlock(&state->mtx);
+        return cars;
+    }
+
+    int getCarsWaiting() {
+        lock();
+        int cars = state->cars_waiting[NORTH] + state->cars_waiting[SOUTH];
+        pthread_mutex_unlock(&state->mtx);
+        return cars;
+    }
+
+private:
+    static const char* directionName(int direction) {
+        return direction == NORTH ? "СЕВЕР" : direction == SOUTH ? "ЮГ" : "НЕТ";
+    }
+
+    // Создатель сегмента мог еще не успеть задать его размер
+    static void waitForSize(int fd) {
+        struct stat info;
+        for (int attempt = 0; attempt < 1000; ++attempt) {
+            if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(SharedState))) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        close(fd);
+        throw std::runtime_error("сегмент разделяемой памяти не инициализирован");
+    }
+
+    void waitForReady() {
+        for (int attempt = 0; attempt < 1000; ++attempt) {
+            if (state->ready.load(std::memory_order_acquire) == READY_MAGIC) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        munmap(state, sizeof(SharedState));
+        state = nullptr;
+        throw std::runtime_error("сегмент разделяемой памяти не инициализирован");
+    }
+
+    void initialize() {
+        // Свежий сегмент после ftruncate заполнен нулями; объекты создаются на месте
+        new (&state->successful_crossings) std::atomic<int>(0);
+        new (&state->total_cars) std::atomic<int>(0);
+        new (&state->direction_switches) std::atomic<int>(0);
+        new (&state->recovered_cars) std::atomic<int>(0);
+        new (&state->wait_times) WaitHistogram();
+
+        pthread_mutexattr_t mutex_attr;
+        pthread_mutexattr_init(&mutex_attr);
+        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&state->mtx, &mutex_attr);
+        for (int i = 0; i < MAX_PROCESSES; ++i) {
+            pthread_mutex_init(&state->slots[i].alive, &mutex_attr);
+        }
+        pthread_mutexattr_destroy(&mutex_attr);
+
+        new (&state->wake_seq) std::atomic<unsigned int>(0);
+
+        state->current_direction = NONE;
+        state->last_direction = NONE;
+        state->ready.store(READY_MAGIC, std::memory_order_release);
+    }
+
+    // Захват мьютекса; если прежний владелец умер, состояние восстанавливается
+    void lock() {
+        int result = pthread_mutex_lock(&state->mtx);
+        if (result != 0 && result != EOWNERDEAD) {
+            throw std::runtime_error(std::string("pthread_mutex_lock: ") + std::strerror(result));
+        }
+        recoverAfter(result);
+    }
+
+    // Результат захвата общего мьютекса: при EOWNERDEAD счетчики пересчитываются,
+    // даже если мертвый слот не найден
+    void recoverAfter(int result) {
+        if (result == EOWNERDEAD) {
+            pthread_mutex_consistent(&state->mtx);
+            recoverDeadProcesses(true);
+        }
+    }
+
+    void registerProcess() {
+        lock();
+        recoverDeadProcesses();
+        for (int i = 0; i < MAX_PROCESSES && slot < 0; ++i) {
+            if (state->slots[i].pid == 0) {
+                slot = i;
+            }
+        }
+        if (slot < 0) {
+            pthread_mutex_unlock(&state->mtx);
+            throw std::runtime_error("к мосту подключено слишком много процессов");
+        }
+
+        // Слот публикуется только после захвата мьютекса жизни, иначе соседи
+        // приняли бы его за слот умершего процесса
+        ProcessSlot& own = state->slots[slot];
+        startLivenessHolder(&own.alive);
+        std::memset(own.cars_on_bridge, 0, sizeof(own.cars_on_bridge));
+        std::memset(own.cars_waiting, 0, sizeof(own.cars_waiting));
+        own.pid = getpid();
+        pthread_mutex_unlock(&state->mtx);
+    }
+
+    void startLivenessHolder(pthread_mutex_t* alive) {
+        liveness_holder = std::thread([this, alive]() {
+            if (pthread_mutex_lock(alive) == EOWNERDEAD) {
+                pthread_mutex_consistent(alive);
+            }
+            std::unique_lock<std::mutex> holder_lock(holder_mtx);
+            holder_locked = true;
+            holder_cv.notify_all();
+            holder_cv.wait(holder_lock, [this]() { return holder_stop; });
+            pthread_mutex_unlock(alive);
+        });
+        std::unique_lock<std::mutex> holder_lock(holder_mtx);
+        holder_cv.wait(holder_lock, [this]() { return holder_locked; });
+    }
+
+    void stopLivenessHolder() {
+        {
+            std::lock_guard<std::mutex> holder_lock(holder_mtx);
+            holder_stop = true;
+        }
+        holder_cv.notify_all();
+        if (liveness_holder.joinable()) {
+            liveness_holder.join();
+        }
+    }
+
+    // Жив ли процесс слота: его мьютекс жизни захвачен. Если удалось захватить самим
+    // (EOWNERDEAD - владелец умер, 0 - отпустил, не освободив слот), процесса нет
+    bool isAlive(ProcessSlot& other) {
+        int result = pthread_mutex_trylock(&other.alive);
+        if (result == EBUSY) {
+            return true;
+        }
+        if (result == EOWNERDEAD) {
+            pthread_mutex_consistent(&other.alive);
+        }
+        if (result == EOWNERDEAD || result == 0) {
+            pthread_mutex_unlock(&other.alive);
+        }
+        return false;
+    }
+
+    // Списание машин процессов, которых больше нет (вызывается под мьютексом).
+    // owner_died - прежний владелец общего мьютекса умер посреди изменения состояния
+    void recoverDeadProcesses(bool owner_died = false) {
+        bool changed = owner_died;
+        for (int i = 0; i < MAX_PROCESSES; ++i) {
+            ProcessSlot& other = state->slots[i];
+            if (other.pid == 0 || i == slot || isAlive(other)) {
+                continue;
+            }
+            std::memset(other.cars_on_bridge, 0, sizeof(other.cars_on_bridge));
+            std::memset(other.cars_waiting, 0, sizeof(other.cars_waiting));
+            other.pid = 0;
+            changed = true;
+        }
+        if (!changed) {
+            return;
+        }
+
+        // Счетчики живых процессов согласованы: их меняют только под этим мьютексом.
+        // Все, что подъехало, но не переехало и не числится за живыми, - списано
+        int in_flight = 0;
+        for (int d = NORTH; d <= SOUTH; ++d) {
+            state->cars_on_bridge[d] = 0;
+            state->cars_waiting[d] = 0;
+            for (int i = 0; i < MAX_PROCESSES; ++i) {
+                if (state->slots[i].pid != 0) {
+                    state->cars_on_bridge[d] += state->slots[i].cars_on_bridge[d];
+                    state->cars_waiting[d] += state->slots[i].cars_waiting[d];
+                }
+            }
+            in_flight += state->cars_on_bridge[d] + state->cars_waiting[d];
+        }
+        state->recovered_cars = state->total_cars - state->successful_crossings - in_flight;
+
+        if (state->cars_on_bridge[NORTH] == 0 && state->cars_on_bridge[SOUTH] == 0) {
+            chooseNextDirection(state->current_direction);
+        }
+        wakeAll();
+    }
+
+    // Пробуждение всех ожидающих (под мьютексом): значение счетчика меняется, поэтому
+    // и те, кто еще не успел заснуть на старом значении, не заснут
+    void wakeAll() {
+        state->wake_seq.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<unsigned int*>(&state->wake_seq), FUTEX_WAKE, INT_MAX,
+                nullptr, nullptr, 0);
+    }
+
+    // Ожидание пробуждения до 50 мс (вызывается под мьютексом, возвращается под ним).
+    // Снимок счетчика берется до освобождения мьютекса, так что пробуждение не теряется.
+    // Возвращает false по таймауту
+    bool waitForWake() {
+        unsigned int seq = state->wake_seq.load(std::memory_order_acquire);
+        pthread_mutex_unlock(&state->mtx);
+        struct timespec timeout = {0, 50 * 1000000L};
+        long result = syscall(SYS_futex, reinterpret_cast<unsigned int*>(&state->wake_seq), FUTEX_WAIT,
+                              seq, &timeout, nullptr, 0);
+        bool timed_out = result != 0 && errno == ETIMEDOUT;
+        lock();
+        return !timed_out;
+    }
+
+    // Условие въезда: как у NarrowBridge, включая лимит пачки
+    bool canEnter(int direction) const {
+        int oncoming = direction == NORTH ? SOUTH : NORTH;
+        if (state->cars_on_bridge[oncoming] != 0) {
+            return false;
+        }
+        if (state->current_direction == NONE) {
+            return true;
+        }
+        if (state->current_direction != direction) {
+            return false;
+        }
+        return config.max_batch <= 0 || state->cars_waiting[oncoming] == 0 ||
+               state->batch_admitted < config.max_batch;
+    }
+
+    // Выбор направления после освобождения моста (под мьютексом)
+    void chooseNextDirection(int finished_direction) {
+        state->batch_admitted = 0;
+        if (finished_direction == NORTH && state->cars_waiting[SOUTH] > 0) {
+            state->current_direction = SOUTH;
+        } else if (finished_direction == SOUTH && state->cars_waiting[NORTH] > 0) {
+            state->current_direction = NORTH;
+        } else if (state->cars_waiting[NORTH] > 0 || state->cars_waiting[SOUTH] > 0) {
+            // Направление неизвестно (восстановление) - пропускаем ту сторону, где ждут
+            state->current_direction = state->cars_waiting[NORTH] > 0 ? NORTH : SOUTH;
+        } else {
+            state->current_direction = NONE;
+        }
+    }
+
+    void arrive(int car_id, int direction) {
+        auto arrived_at = std::chrono::steady_clock::now();
+        ProcessSlot& own = state->slots[slot];
+
+        lock();
+        // Под мьютексом, чтобы при восстановлении total_cars был согласован со слотами
+        state->total_cars++;
+        state->cars_waiting[direction]++;
+        own.cars_waiting[direction]++;
+        if (config.verbose) {
+            std::cout << "[pid " << getpid() << "] Машина " << car_id << " (" << directionName(direction)
+                      << ") подъехала к мосту. Ожидание..." << std::endl;
+        }
+
+        while (!canEnter(direction)) {
+            // Ожидание с таймаутом: машина умершего процесса не разбудит остальных,
+            // поэтому ожидающие сами периодически проверяют участников
+            if (!waitForWake()) {
+                recoverDeadProcesses();
+            }
+        }
+
+        state->cars_waiting[direction]--;
+        own.cars_waiting[direction]--;
+        state->cars_on_bridge[direction]++;
+        own.cars_on_bridge[direction]++;
+        if (state->current_direction != direction) {
+            state->batch_admitted = 0;
+        }
+        if (state->last_direction != direction && state->last_direction != NONE) {
+            state->direction_switches++;
+        }
+        state->current_direction = direction;
+        state->last_direction = direction;
+        state->batch_admitted++;
+        state->wait_times.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - arrived_at));
+        if (config.on_admit) {
+            config.on_admit(car_id, directionName(direction));
+        }
+        pthread_mutex_unlock(&state->mtx);
+
+        // Имитация переезда
+        int crossing_ms = config.crossing_time_ms >= 0 ? config.crossing_time_ms : 500 + car_id % 300;
+        if (crossing_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(crossing_ms));
+        }
+
+        leaveBridge(car_id, direction);
+    }
+
+    void leaveBridge(int car_id, int direction) {
+        ProcessSlot& own = state->slots[slot];
+
+        lock();
+        state->cars_on_bridge[direction]--;
+        own.cars_on_bridge[direction]--;
+        state->successful_crossings++;
+
+        if (state->cars_on_bridge[NORTH] == 0 && state->cars_on_bridge[SOUTH] == 0) {
+            chooseNextDirection(direction);
+        }
+
+        if (config.verbose) {
+            std::cout << "[pid " << getpid() << "] Машина " << car_id << " (" << directionName(direction)
+                      << ") переехала мост. Текущее направление: " << directionName(state->current_direction)
+                      << std::endl;
+        }
+
+        wakeAll();
+        pthread_mutex_unlock(&state->mtx);
+    }
+};
+
+#endif
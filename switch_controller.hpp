@@ -0,0 +1,219 @@
+#ifndef SWITCH_CONTROLLER_HPP
+#define SWITCH_CONTROLLER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Параметры адаптивного контроллера смены направления
+struct SwitchControllerConfig {
+    double p99_target_ms = 1000.0; // Целевой p99 времени ожидания
+    int window_ms = 1000;          // Длина скользящего окна наблюдения
+    int adjust_period_ms = 100;    // Период пересчета лимитов
+    int min_batch = 1;             // Минимальная длина пачки
+    int max_batch = 256;           // Максимальная длина пачки
+    int initial_batch = 8;         // Начальная длина пачки
+};
+
+// Снимок решений контроллера (читается без блокировок)
+struct SwitchControllerMetrics {
+    int north_batch;         // Текущий лимит пачки для севера
+    int south_batch;         // Текущий лимит пачки для юга
+    double north_p99_ms;     // p99 ожидания с севера в окне (с учетом еще ожидающих)
+    double south_p99_ms;     // p99 ожидания с юга в окне (с учетом еще ожидающих)
+    double north_rate;       // Интенсивность прибытия с севера, машин/с
+    double south_rate;       // Интенсивность прибытия с юга, машин/с
+    int north_queue;         // Очередь с севера на момент последнего пересчета
+    int south_queue;         // Очередь с юга на момент последнего пересчета
+    long long adjustments;   // Количество пересчетов
+    long long increases;     // Сколько раз лимит увеличивался
+    long long decreases;     // Сколько раз лимит уменьшался
+};
+
+// Адаптивный контроллер длины пачки: сколько машин подряд может въехать в одном
+// направлении, пока с другой стороны кто-то ждет. Лимиты у направлений свои.
+//
+// По скользящему окну для каждого направления считаются интенсивность прибытия и
+// p99 ожидания (включая возраст самой старой еще ожидающей машины). Если сторона
+// не укладывается в цель, контроллер смотрит на ее очередь: очередь длиннее своей
+// пачки - значит, за один зеленый сигнал ее не разгрузить, и лимит этой стороны
+// удваивается; иначе сторона ждет слишком длинную встречную пачку, и вдвое
+// уменьшается встречный лимит (если встречная очередь сама в него помещается).
+// Когда обе стороны с большим запасом укладываются в цель, а очередь заполняет
+// пачку больше чем наполовину, лимит плавно растет: каждая смена направления
+// стоит полного освобождения моста.
+//
+// Методы on*/update/batchLimit вызываются под мьютексом моста; metrics() - из любого потока.
+class AdaptiveSwitchController {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct WaitSample {
+        Clock::time_point at;
+        long long wait_us;
+    };
+
+    SwitchControllerConfig config;
+
+    std::deque<WaitSample> waits[2];            // Ожидания допущенных машин в окне
+    std::deque<Clock::time_point> arrivals[2];  // Моменты прибытия в окне
+    std::deque<Clock::time_point> pending[2];   // Моменты прибытия еще ожидающих машин
+    int limits[2];
+    Clock::time_point last_adjust;
+
+    std::atomic<int> metric_limits[2];
+    std::atomic<double> metric_p99_ms[2];
+    std::atomic<double> metric_rates[2];
+    std::atomic<int> metric_queues[2];
+    std::atomic<long long> adjustments{0};
+    std::atomic<long long> increases{0};
+    std::atomic<long long> decreases{0};
+
+    static int index(const std::string& direction) {
+        return direction == "СЕВЕР" ? 0 : 1;
+    }
+
+    // p99 ожидания направления в окне с учетом самой старой ожидающей машины
+    double windowP99Ms(int d, Clock::time_point now) const {
+        double p99_ms = 0.0;
+        if (!waits[d].empty()) {
+            std::vector<long long> values;
+            values.reserve(waits[d].size());
+            for (const WaitSample& sample : waits[d]) {
+                values.push_back(sample.wait_us);
+            }
+            size_t rank = static_cast<size_t>(0.99 * (values.size() - 1));
+            std::nth_element(values.begin(), values.begin() + rank, values.end());
+            p99_ms = values[rank] / 1000.0;
+        }
+        // Машины, которые еще стоят, тоже должны учитываться, иначе голодание незаметно
+        if (!pending[d].empty()) {
+            double oldest_ms = std::chrono::duration_cast<std::chrono::microseconds>(
+                now - pending[d].front()).count() / 1000.0;
+            p99_ms = std::max(p99_ms, oldest_ms);
+        }
+        return p99_ms;
+    }
+
+    void adjust(Clock::time_point now, int north_waiting, int south_waiting) {
+        Clock::time_point horizon = now - std::chrono::milliseconds(config.window_ms);
+        for (int d = 0; d < 2; ++d) {
+            while (!waits[d].empty() && waits[d].front().at < horizon) {
+                waits[d].pop_front();
+            }
+            while (!arrivals[d].empty() && arrivals[d].front() < horizon) {
+                arrivals[d].pop_front();
+            }
+        }
+
+        double p99_ms[2] = {windowP99Ms(0, now), windowP99Ms(1, now)};
+        int queued[2] = {static_cast<int>(pending[0].size()), static_cast<int>(pending[1].size())};
+        int next_limits[2] = {limits[0], limits[1]};
+        bool over_target[2] = {p99_ms[0] > config.p99_target_ms, p99_ms[1] > config.p99_target_ms};
+        bool overflow[2] = {queued[0] > limits[0], queued[1] > limits[1]};
+
+        for (int d = 0; d < 2; ++d) {
+            if (!over_target[d]) {
+                continue;
+            }
+            if (overflow[d]) {
+                // Очередь не помещается в пачку - сторону нужно пропускать дольше
+                next_limits[d] = std::max(next_limits[d], limits[d] * 2);
+            } else if (!overflow[1 - d]) {
+                // Сторона ждет, пока пройдет слишком длинная встречная пачка;
+                // встречный лимит не трогаем, если он сам не вмещает свою очередь
+                next_limits[1 - d] = std::min(next_limits[1 - d], limits[1 - d] / 2);
+            }
+        }
+
+        bool has_headroom = p99_ms[0] < config.p99_target_ms / 2 && p99_ms[1] < config.p99_target_ms / 2;
+        if (has_headroom) {
+            for (int d = 0; d < 2; ++d) {
+                if (2 * queued[d] > limits[d]) {
+                    next_limits[d] = limits[d] + std::max(1, limits[d] / 4);
+                }
+            }
+        }
+
+        double window_s = config.window_ms / 1000.0;
+        for (int d = 0; d < 2; ++d) {
+            next_limits[d] = std::max(config.min_batch, std::min(config.max_batch, next_limits[d]));
+            if (next_limits[d] > limits[d]) {
+                increases++;
+            } else if (next_limits[d] < limits[d]) {
+                decreases++;
+            }
+            limits[d] = next_limits[d];
+
+            metric_limits[d].store(limits[d], std::memory_order_relaxed);
+            metric_p99_ms[d].store(p99_ms[d], std::memory_order_relaxed);
+            metric_rates[d].store(arrivals[d].size() / window_s, std::memory_order_relaxed);
+        }
+        metric_queues[0].store(north_waiting, std::memory_order_relaxed);
+        metric_queues[1].store(south_waiting, std::memory_order_relaxed);
+        adjustments++;
+        last_adjust = now;
+    }
+
+public:
+    explicit AdaptiveSwitchController(const SwitchControllerConfig& controller_config = SwitchControllerConfig())
+        : config(controller_config), last_adjust(Clock::now()) {
+        int initial = std::max(config.min_batch, std::min(config.max_batch, config.initial_batch));
+        for (int d = 0; d < 2; ++d) {
+            limits[d] = initial;
+            metric_limits[d].store(initial);
+            metric_p99_ms[d].store(0.0);
+            metric_rates[d].store(0.0);
+            metric_queues[d].store(0);
+        }
+    }
+
+    void onArrival(const std::string& direction, Clock::time_point now) {
+        arrivals[index(direction)].push_back(now);
+        pending[index(direction)].push_back(now);
+    }
+
+    void onAdmission(const std::string& direction, std::chrono::microseconds wait, Clock::time_point now) {
+        WaitSample sample = {now, wait.count()};
+        waits[index(direction)].push_back(sample);
+        // Порядок допуска внутри направления не гарантирован, но для оценки
+        // возраста самой старой ожидающей машины достаточно снять самую раннюю
+        std::deque<Clock::time_point>& queue = pending[index(direction)];
+        if (!queue.empty()) {
+            queue.pop_front();
+        }
+    }
+
+    // Пересчет лимитов, если прошел период; вызывается при каждом событии моста
+    void update(int north_waiting, int south_waiting, Clock::time_point now) {
+        if (now - last_adjust >= std::chrono::milliseconds(config.adjust_period_ms)) {
+            adjust(now, north_waiting, south_waiting);
+        }
+    }
+
+    // Текущий лимит пачки для направления
+    int batchLimit(const std::string& direction) const {
+        return limits[index(direction)];
+    }
+
+    SwitchControllerMetrics metrics() const {
+        SwitchControllerMetrics result;
+        result.north_batch = metric_limits[0].load(std::memory_order_relaxed);
+        result.south_batch = metric_limits[1].load(std::memory_order_relaxed);
+        result.north_p99_ms = metric_p99_ms[0].load(std::memory_order_relaxed);
+        result.south_p99_ms = metric_p99_ms[1].load(std::memory_order_relaxed);
+        result.north_rate = metric_rates[0].load(std::memory_order_relaxed);
+        result.south_rate = metric_rates[1].load(std::memory_order_relaxed);
+        result.north_queue = metric_queues[0].load(std::memory_order_relaxed);
+        result.south_queue = metric_queues[1].load(std::memory_order_relaxed);
+        result.adjustments = adjustments.load(std::memory_order_relaxed);
+        result.increases = increases.load(std::memory_order_relaxed);
+        result.decreases = decreases.load(std::memory_order_relaxed);
+        return result;
+    }
+};
+
+#endif
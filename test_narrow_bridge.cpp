@@ -1,6 +1,11 @@
 #include "narrow_bridge_test.hpp"
+#include "shared_bridge.hpp"
+#include "metrics_exporter.hpp"
 #include <chrono>
 #include <atomic>
+#include <cstdio>
+#include <signal.h>
+#include <sys/wait.h>
 
 // Тест 1: Базовая функциональность - одиночные машины
 class SingleCarTest : public TestBase {
@@ -277,6 +282,575 @@ private:
     }
 };
 
+// Тест 6: Параметры моделирования (тихий режим и фиксированное время переезда)
+class ConfigTest : public TestBase {
+public:
+    void run_all_tests() override {
+        std::cout << "\n=== ТЕСТ 6: ПАРАМЕТРЫ МОДЕЛИРОВАНИЯ ===" << std::endl;
+        
+        test_fixed_crossing_time();
+        test_wait_from_scheduled_arrival();
+    }
+
+private:
+    void test_fixed_crossing_time() {
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 0;
+        NarrowBridge bridge(config);
+        const int num_cars = 200;
+        std::vector<std::thread> cars;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 1; i <= num_cars; ++i) {
+            if (i % 2 == 0) {
+                cars.emplace_back(&NarrowBridge::arriveFromNorth, &bridge, i);
+            } else {
+                cars.emplace_back(&NarrowBridge::arriveFromSouth, &bridge, i);
+            }
+        }
+        for (auto& car : cars) {
+            if (car.joinable()) car.join();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        
+        test_assert(bridge.getSuccessfulCrossings() == num_cars, 
+                   "Все " + std::to_string(num_cars) + " машин переехали с нулевым временем переезда");
+        test_assert(elapsed < std::chrono::seconds(5), 
+                   "Фиксированное время переезда заменяет исходные 500-800 мс");
+    }
+
+    void test_wait_from_scheduled_arrival() {
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 0;
+        NarrowBridge bridge(config);
+
+        // Машина подана на 200 мс позже расписания - опоздание входит в ожидание
+        auto scheduled_at = std::chrono::steady_clock::now() - std::chrono::milliseconds(200);
+        bridge.arriveFromNorthAt(1, scheduled_at);
+        bridge.arriveFromSouthAt(2, std::chrono::steady_clock::now());
+
+        test_assert(bridge.getSuccessfulCrossings() == 2, "Машины с заданным моментом прибытия переехали");
+        test_assert(bridge.getWaitTimes().maxMs() >= 200.0,
+                   "Ожидание отсчитывается от момента прибытия по расписанию");
+    }
+};
+
+// Тест 7: Лимит пачки и адаптивный контроллер смены направления
+class SwitchingTest : public TestBase {
+public:
+    void run_all_tests() override {
+        std::cout << "\n=== ТЕСТ 7: ЛИМИТ ПАЧКИ И АДАПТИВНЫЙ КОНТРОЛЛЕР ===" << std::endl;
+        
+        test_fixed_batch_limit();
+        test_controller_grows_overflowing_side();
+        test_controller_shrinks_hogging_side();
+        test_bridge_with_controller();
+        test_histogram_percentiles();
+    }
+
+private:
+    // Машины с обеих сторон подъезжают одновременно; возвращает число переездов
+    int run_mixed_traffic(NarrowBridge& bridge, int num_cars) {
+        std::vector<std::thread> cars;
+        for (int i = 1; i <= num_cars; ++i) {
+            if (i % 2 == 0) {
+                cars.emplace_back(&NarrowBridge::arriveFromNorth, &bridge, i);
+            } else {
+                cars.emplace_back(&NarrowBridge::arriveFromSouth, &bridge, i);
+            }
+        }
+        for (auto& car : cars) {
+            if (car.joinable()) car.join();
+        }
+        return bridge.getSuccessfulCrossings();
+    }
+    
+    void test_fixed_batch_limit() {
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 5;
+        config.max_batch = 1;
+        NarrowBridge bridge(config);
+        
+        test_assert(run_mixed_traffic(bridge, 40) == 40, "С лимитом пачки 1 все 40 машин переехали");
+        test_assert(bridge.getDirectionSwitches() >= 10, 
+                   "Лимит пачки заставляет чередовать направления (смен: " + 
+                   std::to_string(bridge.getDirectionSwitches()) + ")");
+        test_assert(bridge.getWaitTimes().count() == 40, "Время ожидания записано для каждой машины");
+    }
+    
+    void test_controller_grows_overflowing_side() {
+        SwitchControllerConfig config;
+        config.p99_target_ms = 100;
+        config.initial_batch = 4;
+        AdaptiveSwitchController controller(config);
+        
+        // Очередь с севера длиннее пачки и ждет дольше цели
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 10; ++i) {
+            controller.onArrival("СЕВЕР", start);
+        }
+        controller.update(10, 0, start + std::chrono::milliseconds(200));
+        
+        test_assert(controller.batchLimit("СЕВЕР") == 8, "Лимит переполненной стороны удвоился");
+        test_assert(controller.batchLimit("ЮГ") == 4, "Лимит встречной стороны не изменился");
+        test_assert(controller.metrics().increases == 1, "Решение отражено в метриках");
+    }
+    
+    void test_controller_shrinks_hogging_side() {
+        SwitchControllerConfig config;
+        config.p99_target_ms = 100;
+        config.initial_batch = 4;
+        AdaptiveSwitchController controller(config);
+        
+        // Одна машина с юга ждет дольше цели, хотя ее очередь помещается в пачку
+        auto start = std::chrono::steady_clock::now();
+        controller.onArrival("ЮГ", start);
+        controller.update(0, 1, start + std::chrono::milliseconds(200));
+        
+        test_assert(controller.batchLimit("СЕВЕР") == 2, "Лимит встречной стороны уменьшился вдвое");
+        test_assert(controller.batchLimit("ЮГ") == 4, "Лимит ожидающей стороны не изменился");
+        test_assert(controller.metrics().decreases == 1, "Решение отражено в метриках");
+    }
+    
+    void test_bridge_with_controller() {
+        SwitchControllerConfig controller_config;
+        controller_config.p99_target_ms = 50;
+        controller_config.adjust_period_ms = 10;
+        AdaptiveSwitchController controller(controller_config);
+        
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 5;
+        config.switch_controller = &controller;
+        NarrowBridge bridge(config);
+        
+        test_assert(run_mixed_traffic(bridge, 60) == 60, "С адаптивным контроллером все 60 машин переехали");
+        test_assert(controller.metrics().adjustments > 0, "Контроллер пересчитывал лимиты");
+    }
+
+    void test_histogram_percentiles() {
+        WaitHistogram small;
+        for (int us = 10; us <= 30; us += 10) {
+            small.record(std::chrono::microseconds(us));
+        }
+        test_assert(small.percentileMs(0.5) >= 0.010 && small.percentileMs(0.99) <= 0.030,
+                   "Квантили первой корзины лежат между минимумом и максимумом");
+
+        WaitHistogram large;
+        for (int i = 0; i < 100; ++i) {
+            large.record(std::chrono::microseconds(46000000 + i));
+        }
+        test_assert(large.percentileMs(0.99) <= large.maxMs(), "p99 не превышает максимум");
+    }
+};
+
+// Тест 8: Мост в разделяемой памяти для нескольких процессов
+class SharedBridgeTest : public TestBase {
+public:
+    void run_all_tests() override {
+        std::cout << "\n=== ТЕСТ 8: МОСТ В РАЗДЕЛЯЕМОЙ ПАМЯТИ ===" << std::endl;
+        
+        test_multiple_processes();
+        test_recovery_after_process_death();
+        test_recovery_after_waiter_death();
+        test_recovery_after_death_under_lock();
+    }
+
+private:
+    static BridgeConfig quiet_config(int crossing_ms) {
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = crossing_ms;
+        return config;
+    }
+    
+    void test_multiple_processes() {
+        const std::string name = "/narrow_bridge_test_" + std::to_string(getpid());
+        SharedNarrowBridge::remove(name);
+        SharedNarrowBridge bridge(name, quiet_config(1));
+        const int num_processes = 4;
+        const int cars_per_process = 10;
+        
+        std::vector<pid_t> children;
+        for (int p = 0; p < num_processes; ++p) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                // Дочерний процесс открывает тот же сегмент по имени
+                SharedNarrowBridge child_bridge(name, quiet_config(1));
+                std::vector<std::thread> cars;
+                for (int i = 1; i <= cars_per_process; ++i) {
+                    int car_id = p * cars_per_process + i;
+                    if ((p + i) % 2 == 0) {
+                        cars.emplace_back(&SharedNarrowBridge::arriveFromNorth, &child_bridge, car_id);
+                    } else {
+                        cars.emplace_back(&SharedNarrowBridge::arriveFromSouth, &child_bridge, car_id);
+                    }
+                }
+                for (auto& car : cars) {
+                    car.join();
+                }
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        
+        bool all_exited = true;
+        for (pid_t child : children) {
+            int status = 0;
+            waitpid(child, &status, 0);
+            all_exited = all_exited && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+        
+        const int total = num_processes * cars_per_process;
+        test_assert(all_exited, "Все дочерние процессы завершились успешно");
+        test_assert(bridge.getSuccessfulCrossings() == total, 
+                   "Все " + std::to_string(total) + " машин из разных процессов переехали мост");
+        test_assert(bridge.allCarsCrossedSuccessfully(), "Общая статистика согласована между процессами");
+        test_assert(bridge.getWaitTimes().count() == total, "Время ожидания записано в общий сегмент");
+        
+        SharedNarrowBridge::remove(name);
+    }
+    
+    void test_recovery_after_process_death() {
+        const std::string name = "/narrow_bridge_test_dead_" + std::to_string(getpid());
+        SharedNarrowBridge::remove(name);
+        SharedNarrowBridge bridge(name, quiet_config(10));
+        
+        // Процесс въезжает на мост с севера и "умирает" посреди переезда
+        pid_t child = fork();
+        if (child == 0) {
+            BridgeConfig slow = quiet_config(60000);
+            SharedNarrowBridge child_bridge(name, slow);
+            child_bridge.arriveFromNorth(1);
+            _exit(0);
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        while (bridge.getCarsOnBridge() == 0 && 
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        test_assert(bridge.getCarsOnBridge() == 1, "Машина другого процесса находится на мосту");
+        
+        // Процесс не дожидаемся: восстановление не должно зависеть от того, что
+        // родитель уже забрал зомби
+        kill(child, SIGKILL);
+        
+        // Встречная машина должна проехать после списания машины умершего процесса
+        std::atomic<bool> crossed{false};
+        std::thread south_car([&]() {
+            bridge.arriveFromSouth(2);
+            crossed = true;
+        });
+        start = std::chrono::steady_clock::now();
+        while (!crossed && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        
+        test_assert(crossed, "Встречная машина проехала после гибели процесса на мосту");
+        test_assert(bridge.getRecoveredCars() == 1, "Машина умершего процесса списана");
+        test_assert(bridge.allCarsCrossedSuccessfully(), "Статистика учитывает списанные машины");
+        
+        if (south_car.joinable()) south_car.join();
+        waitpid(child, nullptr, 0);
+        SharedNarrowBridge::remove(name);
+    }
+    
+    void test_recovery_after_waiter_death() {
+        const std::string name = "/narrow_bridge_test_waiter_" + std::to_string(getpid());
+        SharedNarrowBridge::remove(name);
+        SharedNarrowBridge bridge(name, quiet_config(10));
+        
+        // Один процесс занимает мост с севера на 1 с, другие ждут въезда с юга
+        pid_t holder = fork();
+        if (holder == 0) {
+            SharedNarrowBridge child_bridge(name, quiet_config(1000));
+            child_bridge.arriveFromNorth(1);
+            _exit(0);
+        }
+        auto start = std::chrono::steady_clock::now();
+        while (bridge.getCarsOnBridge() == 0 && 
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        
+        const int num_waiters = 4;
+        std::vector<pid_t> waiters;
+        for (int p = 0; p < num_waiters; ++p) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                SharedNarrowBridge child_bridge(name, quiet_config(10));
+                child_bridge.arriveFromSouth(10 + p);
+                _exit(0);
+            }
+            waiters.push_back(pid);
+        }
+        start = std::chrono::steady_clock::now();
+        while (bridge.getCarsWaiting() < num_waiters && 
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        test_assert(bridge.getCarsWaiting() == num_waiters, "Машины других процессов ждут въезда");
+        
+        // Процессы гибнут, пока их машины ждут въезда
+        for (pid_t waiter : waiters) {
+            kill(waiter, SIGKILL);
+        }
+        
+        const int num_cars = 20;
+        std::atomic<int> crossed{0};
+        std::vector<std::thread> cars;
+        for (int i = 0; i < num_cars; ++i) {
+            cars.emplace_back([&bridge, &crossed, i]() {
+                if (i % 2 == 0) {
+                    bridge.arriveFromNorth(100 + i);
+                } else {
+                    bridge.arriveFromSouth(100 + i);
+                }
+                crossed++;
+            });
+        }
+        start = std::chrono::steady_clock::now();
+        while (crossed < num_cars && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        
+        test_assert(crossed == num_cars, "Мост не заблокирован после гибели ожидающих процессов");
+        test_assert(bridge.getRecoveredCars() == num_waiters, "Машины погибших ожидающих списаны");
+        
+        for (auto& car : cars) {
+            if (car.joinable()) car.join();
+        }
+        for (pid_t waiter : waiters) {
+            waitpid(waiter, nullptr, 0);
+        }
+        int status = 0;
+        waitpid(holder, &status, 0);
+        test_assert(WIFEXITED(status) && bridge.allCarsCrossedSuccessfully(),
+                   "Машина процесса на мосту доехала, статистика согласована");
+        SharedNarrowBridge::remove(name);
+    }
+    
+    void test_recovery_after_death_under_lock() {
+        const std::string name = "/narrow_bridge_test_locked_" + std::to_string(getpid());
+        SharedNarrowBridge::remove(name);
+        SharedNarrowBridge bridge(name, quiet_config(10));
+        
+        // Процесс погибает при въезде, удерживая общий мьютекс
+        pid_t child = fork();
+        if (child == 0) {
+            BridgeConfig dying = quiet_config(60000);
+            dying.on_admit = [](int, const std::string&) {
+                raise(SIGKILL);
+            };
+            SharedNarrowBridge child_bridge(name, dying);
+            child_bridge.arriveFromNorth(1);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        test_assert(WIFSIGNALED(status), "Дочерний процесс погиб под мьютексом моста");
+        
+        // Следующий захват получает EOWNERDEAD, и счетчики пересчитываются по живым слотам
+        std::atomic<int> crossed{0};
+        std::thread north_car([&]() {
+            bridge.arriveFromNorth(2);
+            crossed++;
+        });
+        std::thread south_car([&]() {
+            bridge.arriveFromSouth(3);
+            crossed++;
+        });
+        auto start = std::chrono::steady_clock::now();
+        while (crossed < 2 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        
+        test_assert(crossed == 2, "Машины обоих направлений проехали после гибели владельца мьютекса");
+        test_assert(bridge.getCarsOnBridge() == 0, "Счетчик машин на мосту не ушел в минус");
+        test_assert(bridge.getRecoveredCars() == 1, "Машина погибшего процесса списана один раз");
+        test_assert(bridge.allCarsCrossedSuccessfully(), "Статистика согласована после восстановления");
+        
+        if (north_car.joinable()) north_car.join();
+        if (south_car.joinable()) south_car.join();
+        SharedNarrowBridge::remove(name);
+    }
+};
+
+// Тест 9: Очередь FIFO с передачей права проезда
+class FifoHandoffTest : public TestBase {
+public:
+    void run_all_tests() override {
+        std::cout << "\n=== ТЕСТ 9: ОЧЕРЕДЬ FIFO ===" << std::endl;
+        
+        test_arrival_order_preserved();
+        test_mixed_traffic_fifo();
+    }
+
+private:
+    void test_arrival_order_preserved() {
+        std::mutex order_mtx;
+        std::vector<int> north_order;
+        
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 100;
+        config.fifo_handoff = true;
+        config.max_batch = 1;
+        config.on_admit = [&](int car_id, const std::string& direction) {
+            std::lock_guard<std::mutex> lock(order_mtx);
+            if (direction == "СЕВЕР") {
+                north_order.push_back(car_id);
+            }
+        };
+        NarrowBridge bridge(config);
+        
+        // Машина с юга занимает мост, за ней по очереди встают северные и южные машины.
+        // Лимит пачки 1 чередует направления, поэтому северные машины допускаются по
+        // одной, и обработчик въезда видит порядок допуска, а не порядок пробуждения
+        std::vector<std::thread> cars;
+        cars.emplace_back(&NarrowBridge::arriveFromSouth, &bridge, 100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const int num_cars = 6;
+        for (int i = 1; i <= num_cars; ++i) {
+            cars.emplace_back(&NarrowBridge::arriveFromNorth, &bridge, i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            cars.emplace_back(&NarrowBridge::arriveFromSouth, &bridge, 100 + i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        for (auto& car : cars) {
+            if (car.joinable()) car.join();
+        }
+        
+        std::vector<int> expected;
+        for (int i = 1; i <= num_cars; ++i) {
+            expected.push_back(i);
+        }
+        test_assert(north_order == expected, "Машины с севера въехали строго в порядке прибытия");
+        test_assert(bridge.getSuccessfulCrossings() == 2 * num_cars + 1, "Все машины переехали мост");
+    }
+    
+    void test_mixed_traffic_fifo() {
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 2;
+        config.max_batch = 4;
+        config.fifo_handoff = true;
+        NarrowBridge bridge(config);
+        const int num_cars = 100;
+        std::vector<std::thread> cars;
+        
+        for (int i = 1; i <= num_cars; ++i) {
+            if (i % 3 == 0) {
+                cars.emplace_back(&NarrowBridge::arriveFromNorth, &bridge, i);
+            } else {
+                cars.emplace_back(&NarrowBridge::arriveFromSouth, &bridge, i);
+            }
+        }
+        for (auto& car : cars) {
+            if (car.joinable()) car.join();
+        }
+        
+        test_assert(bridge.getSuccessfulCrossings() == num_cars, 
+                   "В режиме FIFO с лимитом пачки все " + std::to_string(num_cars) + " машин переехали");
+        test_assert(bridge.allCarsCrossedSuccessfully(), "allCarsCrossedSuccessfully в режиме FIFO");
+    }
+};
+
+// Тест 10: Экспорт метрик в формате Prometheus
+class MetricsExporterTest : public TestBase {
+public:
+    void run_all_tests() override {
+        std::cout << "\n=== ТЕСТ 10: ЭКСПОРТ МЕТРИК ===" << std::endl;
+        
+        test_render_after_crossings();
+        test_scrape_over_unix_socket();
+        test_unix_path_not_a_socket();
+    }
+
+private:
+    static bool contains(const std::string& text, const std::string& fragment) {
+        return text.find(fragment) != std::string::npos;
+    }
+    
+    void test_render_after_crossings() {
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 0;
+        NarrowBridge bridge(config);
+        bridge.arriveFromNorth(1);
+        bridge.arriveFromSouth(2);
+        
+        std::string text = MetricsExporter::render(bridge);
+        test_assert(contains(text, "narrow_bridge_crossings_total 2\n"), "Экспортирован счетчик переездов");
+        test_assert(contains(text, "narrow_bridge_direction_switches_total 1\n"), "Экспортированы смены направления");
+        test_assert(contains(text, "narrow_bridge_cars_waiting{direction=\"north\"} 0\n"), 
+                   "Экспортирована очередь по направлениям");
+        test_assert(contains(text, "narrow_bridge_wait_seconds_bucket{le=\"+Inf\"} 2\n") &&
+                    contains(text, "narrow_bridge_wait_seconds_count 2\n"), 
+                   "Экспортирована гистограмма ожидания");
+        test_assert(!contains(text, "narrow_bridge_batch_limit"), "Без контроллера его метрики не выводятся");
+    }
+    
+    void test_unix_path_not_a_socket() {
+        NarrowBridge bridge;
+        const std::string path = "/tmp/narrow_bridge_metrics_" + std::to_string(getpid()) + ".txt";
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (file) {
+            std::fputs("данные\n", file);
+            std::fclose(file);
+        }
+        
+        bool rejected = false;
+        try {
+            MetricsExporter exporter(bridge, "unix:" + path);
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        test_assert(rejected, "Экспортер не открывается поверх обычного файла");
+        test_assert(access(path.c_str(), F_OK) == 0, "Обычный файл по пути сокета не удален");
+        unlink(path.c_str());
+    }
+    
+    void test_scrape_over_unix_socket() {
+        BridgeConfig config;
+        config.verbose = false;
+        config.crossing_time_ms = 0;
+        NarrowBridge bridge(config);
+        bridge.arriveFromNorth(1);
+        
+        const std::string path = "/tmp/narrow_bridge_metrics_" + std::to_string(getpid()) + ".sock";
+        std::string response;
+        {
+            MetricsExporter exporter(bridge, "unix:" + path);
+            
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un address;
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+                const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+                ssize_t ignored = send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+                (void)ignored;
+                char buffer[4096];
+                ssize_t received;
+                while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                    response.append(buffer, static_cast<size_t>(received));
+                }
+            }
+            close(fd);
+        }
+        
+        test_assert(contains(response, "HTTP/1.0 200 OK"), "Экспортер отвечает по HTTP через Unix-сокет");
+        test_assert(contains(response, "narrow_bridge_crossings_total 1\n"), "Ответ содержит текущие счетчики");
+        test_assert(access(path.c_str(), F_OK) != 0, "Сокет удален после остановки экспортера");
+    }
+};
+
 // Главная функция запуска всех тестов
 int main() {
     std::cout << "ЗАПУСК ТЕСТИРОВАНИЯ КЛАССА NarrowBridge" << std::endl;
@@ -288,12 +862,22 @@ int main() {
     AlternatingDirectionsTest test3;
     StatisticsTest test4;
     StressTest test5;
+    ConfigTest test6;
+    SwitchingTest test7;
+    SharedBridgeTest test8;
+    FifoHandoffTest test9;
+    MetricsExporterTest test10;
     
     test1.run_all_tests();
     test2.run_all_tests();
     test3.run_all_tests();
     test4.run_all_tests();
     test5.run_all_tests();
+    test6.run_all_tests();
+    test7.run_all_tests();
+    test8.run_all_tests();
+    test9.run_all_tests();
+    test10.run_all_tests();
     
     // Выводим общую статистику
     std::cout << "\n=== ОБЩАЯ СТАТИСТИКА ТЕСТИРОВАНИЯ ===" << std::endl;
@@ -301,10 +885,14 @@ int main() {
     // Собираем общую статистику из всех тестов
     int total_passed = test1.get_passed_tests() + test2.get_passed_tests() + 
                       test3.get_passed_tests() + test4.get_passed_tests() + 
-                      test5.get_passed_tests();
+                      test5.get_passed_tests() + test6.get_passed_tests() + 
+                      test7.get_passed_tests() + test8.get_passed_tests() + 
+                      test9.get_passed_tests() + test10.get_passed_tests();
     int total_tests = test1.get_total_tests() + test2.get_total_tests() + 
                      test3.get_total_tests() + test4.get_total_tests() + 
-                     test5.get_total_tests();
+                     test5.get_total_tests() + test6.get_total_tests() + 
+                     test7.get_total_tests() + test8.get_total_tests() + 
+                     test9.get_total_tests() + test10.get_total_tests();
     
     std::cout << "Пройдено: " << total_passed << "/" << total_tests << " тестов" << std::endl;
     
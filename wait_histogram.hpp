@@ -0,0 +1,129 @@
+#ifndef WAIT_HISTOGRAM_HPP
+#define WAIT_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <vector>
+
+// Гистограмма времени ожидания у моста.
+// Запись и чтение без блокировок: счетчики атомарные, поэтому снимок можно
+// снимать из любого потока, не захватывая мьютекс моста.
+class WaitHistogram {
+public:
+    // Границы корзин растут геометрически: 50 мкс * 1.25^k, примерно до 60 с
+    static const int BUCKET_COUNT = 64;
+
+private:
+    std::atomic<long long> buckets[BUCKET_COUNT + 1]; // Последняя корзина - "+Inf"
+    std::atomic<long long> total_count{0};
+    std::atomic<long long> total_us{0};
+    std::atomic<long long> max_us{0};
+    std::atomic<long long> min_us{LLONG_MAX};
+
+public:
+    WaitHistogram() {
+        for (int i = 0; i <= BUCKET_COUNT; ++i) {
+            buckets[i].store(0);
+        }
+    }
+
+    // Верхняя граница корзины в микросекундах
+    static double bucketBoundUs(int index) {
+        static const std::vector<double> bounds = []() {
+            std::vector<double> result;
+            double bound = 50.0;
+            for (int i = 0; i < BUCKET_COUNT; ++i) {
+                result.push_back(bound);
+                bound *= 1.25;
+            }
+            return result;
+        }();
+        return bounds[index];
+    }
+
+    void record(std::chrono::microseconds wait) {
+        long long us = wait.count() < 0 ? 0 : wait.count();
+
+        // Двоичный поиск корзины
+        int low = 0;
+        int high = BUCKET_COUNT;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (us <= bucketBoundUs(mid)) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+
+        buckets[low].fetch_add(1, std::memory_order_relaxed);
+        total_count.fetch_add(1, std::memory_order_relaxed);
+        total_us.fetch_add(us, std::memory_order_relaxed);
+
+        long long previous = max_us.load(std::memory_order_relaxed);
+        while (us > previous && !max_us.compare_exchange_weak(previous, us, std::memory_order_relaxed)) {
+        }
+        previous = min_us.load(std::memory_order_relaxed);
+        while (us < previous && !min_us.compare_exchange_weak(previous, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    long long count() const {
+        return total_count.load(std::memory_order_relaxed);
+    }
+
+    // Количество записей в корзине index (BUCKET_COUNT - корзина "+Inf")
+    long long bucketCount(int index) const {
+        return buckets[index].load(std::memory_order_relaxed);
+    }
+
+    double sumMs() const {
+        return total_us.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+    double maxMs() const {
+        return max_us.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+    double minMs() const {
+        long long us = min_us.load(std::memory_order_relaxed);
+        return us == LLONG_MAX ? 0.0 : us / 1000.0;
+    }
+
+    // Оценка квантиля (q от 0 до 1) в миллисекундах с интерполяцией внутри корзины.
+    // Крайние корзины сужаются до наблюдавшихся минимума и максимума: иначе все значения
+    // меньше 50 мкс выглядели бы как 0-50 мкс, а p99 мог оказаться больше максимума
+    double percentileMs(double q) const {
+        long long counts[BUCKET_COUNT + 1];
+        long long total = 0;
+        for (int i = 0; i <= BUCKET_COUNT; ++i) {
+            counts[i] = bucketCount(i);
+            total += counts[i];
+        }
+        if (total == 0) {
+            return 0.0;
+        }
+
+        double min_value_us = minMs() * 1000.0;
+        double max_value_us = maxMs() * 1000.0;
+        double rank = q * total;
+        long long seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            if (counts[i] > 0 && seen + counts[i] >= rank) {
+                double lower = std::max(i == 0 ? 0.0 : bucketBoundUs(i - 1), min_value_us);
+                double upper = std::min(bucketBoundUs(i), max_value_us);
+                if (upper < lower) {
+                    upper = lower; // Минимум и максимум читаются не атомарно с корзинами
+                }
+                double fraction = (rank - seen) / counts[i];
+                return std::min(lower + (upper - lower) * fraction, max_value_us) / 1000.0;
+            }
+            seen += counts[i];
+        }
+        return maxMs();
+    }
+};
+
+#endif